@@ -2,10 +2,15 @@ TEMPLATE = app
 CONFIG += console
 CONFIG -= app_bundle
 CONFIG -= qt
+CONFIG += c++11
 
 INCLUDEPATH += $PWD
 
 # FLAGS
+# the batch and composed WFG problems, and the batch uncertainty kernel, are
+# bit-identical to the scalar ones
+# only if the compiler does not fuse multiply-adds
+QMAKE_CXXFLAGS += -ffp-contract=off
 
 SOURCES += main.cpp \
     core/RandomDistributions.cpp \
@@ -13,9 +18,18 @@ SOURCES += main.cpp \
     core/CODeMOperators.cpp \
     core/CODeMProblems.cpp \
     core/UncertaintyKernel.cpp \
+    core/UncertaintyKernelView.cpp \
+    core/PeakDistributionCache.cpp \
+    core/DistributionExpression.cpp \
     core/utils/AbstractInterpolator.cpp \
     core/utils/LinearInterpolator.cpp \
+    core/utils/Convolution.cpp \
+    core/utils/NormKernels.cpp \
+    core/utils/RandomStream.cpp \
+    core/utils/ThreadPool.cpp \
+    libs/DTLZ/DTLZBatchProblems.cpp \
     libs/DTLZ/DTLZProblems.cpp \
+    libs/WFG/BatchProblems.cpp \
     libs/WFG/ExampleProblems.cpp \
     libs/WFG/ExampleShapes.cpp \
     libs/WFG/ExampleTransitions.cpp \
@@ -30,13 +44,24 @@ HEADERS += \
     core/CODeMOperators.h \
     core/CODeMProblems.h \
     core/UncertaintyKernel.h \
+    core/PeakDistributionCache.h \
+    core/DistributionExpression.h \
     core/utils/AbstractInterpolator.h \
     core/utils/LinearInterpolator.h \
+    core/utils/Convolution.h \
+    core/utils/NormKernels.h \
+    core/utils/RandomStream.h \
+    core/utils/Span.h \
+    core/utils/ThreadPool.h \
+    libs/DTLZ/DTLZBatchProblems.h \
     libs/DTLZ/DTLZProblems.h \
+    libs/WFG/BatchProblems.h \
+    libs/WFG/ComposedProblems.h \
     libs/WFG/ExampleProblems.h \
     libs/WFG/ExampleShapes.h \
     libs/WFG/ExampleTransitions.h \
     libs/WFG/FrameworkFunctions.h \
+    libs/WFG/InlineTransFunctions.h \
     libs/WFG/Misc.h \
     libs/WFG/ShapeFunctions.h \
     libs/WFG/TransFunctions.h
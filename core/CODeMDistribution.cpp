@@ -15,22 +15,39 @@
 ****************************************************************************/
 #include <core/CODeMDistribution.h>
 #include <core/CODeMOperators.h>
+#include <core/utils/RandomStream.h>
 #include <core/Distributions/IDistribution.h>
 #include <tigon/Utils/NormalisationUtils.h>
 
 namespace CODeM {
 
+CODeMDistribution::CODeMDistribution()
+    : m_distribution(0),
+      m_directionPertRadius(0.0),
+      m_lb(0.0),
+      m_ub(1.0),
+      m_pNorm(1),
+      m_normType(L1Norm),
+      m_stream(0)
+{
+
+}
+
 CODeMDistribution::CODeMDistribution(IDistribution* d,
-                                     const vector<double> oVec,
+                                     const vector<double>& oVec,
                                      double lowerBound,
                                      double upperBound,
-                                     const vector<double> ideal,
-                                     const vector<double> antiIdeal,
+                                     const vector<double>& ideal,
+                                     const vector<double>& antiIdeal,
                                      double dirPertRad,
                                      double dirPertNorm)
-    : m_lb(lowerBound),
+    : m_distribution(0),
+      m_directionPertRadius(0.0),
+      m_lb(lowerBound),
       m_ub(upperBound),
-      m_pNorm(1)
+      m_pNorm(1),
+      m_normType(L1Norm),
+      m_stream(0)
 {
     defineDistribution(d);
     defineIdealAndAntiIdeal(ideal, antiIdeal);
@@ -39,16 +56,50 @@ CODeMDistribution::CODeMDistribution(IDistribution* d,
     definePerturbationNorm(dirPertNorm);
 }
 
-CODeMDistribution::~CODeMDistribution()
+CODeMDistribution::CODeMDistribution(const CODeMDistribution& cd)
+    : m_distribution(cd.m_distribution ? cd.m_distribution->clone() : 0),
+      m_directionPertRadius(cd.m_directionPertRadius),
+      m_direction(cd.m_direction),
+      m_ideal(cd.m_ideal),
+      m_antiIdeal(cd.m_antiIdeal),
+      m_lb(cd.m_lb),
+      m_ub(cd.m_ub),
+      m_pNorm(cd.m_pNorm),
+      m_normType(cd.m_normType),
+      m_stream(cd.m_stream)
 {
 
 }
 
+CODeMDistribution& CODeMDistribution::operator=(const CODeMDistribution& cd)
+{
+    if(this != &cd) {
+        defineDistribution(cd.m_distribution ? cd.m_distribution->clone()
+                                             : 0);
+        m_directionPertRadius = cd.m_directionPertRadius;
+        m_direction = cd.m_direction;
+        m_ideal     = cd.m_ideal;
+        m_antiIdeal = cd.m_antiIdeal;
+        m_lb        = cd.m_lb;
+        m_ub        = cd.m_ub;
+        m_pNorm     = cd.m_pNorm;
+        m_normType  = cd.m_normType;
+        m_stream    = cd.m_stream;
+    }
+    return *this;
+}
+
+CODeMDistribution::~CODeMDistribution()
+{
+    delete m_distribution;
+}
+
 vector<double> CODeMDistribution::sampleDistribution()
 {
-    if(m_distribution.isNull()) {
+    if(m_distribution == 0) {
         return vector<double>(0);
     }
+    ScopedRandomStream streamGuard(m_stream ? m_stream : currentRandomStream());
     double sFactor = m_distribution->sample();
 
     // scale to the interval [lb ub]
@@ -58,13 +109,53 @@ vector<double> CODeMDistribution::sampleDistribution()
     vector<double> samp = m_direction;
     scale(samp,sFactor);
 
-    samp = directionPerturbation(samp, m_directionPertRadius, m_pNorm);
+    directionPerturbation(samp.data(), 1, samp.size(),
+                          m_directionPertRadius, m_normType, m_pNorm);
 
     scaleBackFromUnitBox(samp, m_ideal, m_antiIdeal);
 
     return samp;
 }
 
+void CODeMDistribution::sampleDistribution(int nSamp, double* out)
+{
+    if(m_distribution == 0 || out == 0) {
+        return;
+    }
+    int nObj = m_direction.size();
+    ScopedRandomStream streamGuard(m_stream ? m_stream : currentRandomStream());
+
+    // the scaled 2-norm direction vectors
+    for(int i=0; i<nSamp; i++) {
+        double sFactor = m_distribution->sample();
+        sFactor = m_lb + sFactor*(m_ub-m_lb);
+
+        double* samp = out + i*nObj;
+        for(int j=0; j<nObj; j++) {
+            samp[j] = sFactor * m_direction[j];
+        }
+    }
+
+    directionPerturbation(out, nSamp, nObj, m_directionPertRadius,
+                          m_normType, m_pNorm);
+
+    // scaleBackFromUnitBox() of every row, in place
+    if((int)m_ideal.size() != nObj || (int)m_antiIdeal.size() != nObj) {
+        return;
+    }
+    for(int i=0; i<nSamp; i++) {
+        double* samp = out + i*nObj;
+        for(int j=0; j<nObj; j++) {
+            samp[j] = samp[j] * (m_antiIdeal[j] - m_ideal[j]) + m_ideal[j];
+        }
+    }
+}
+
+int CODeMDistribution::nObj() const
+{
+    return m_direction.size();
+}
+
 void CODeMDistribution::defineDirectionPertRadius(double r)
 {
     if(r >= 0.0) {
@@ -76,25 +167,50 @@ void CODeMDistribution::definePerturbationNorm(double p)
 {
     if(p > 0.0) {
         m_pNorm = p;
+        m_normType = normType(p);
     }
 }
 
-void CODeMDistribution::defineDirection(const vector<double> oVec)
+void CODeMDistribution::defineBoundaries(double lowerBound, double upperBound)
+{
+    m_lb = lowerBound;
+    m_ub = upperBound;
+}
+
+void CODeMDistribution::defineDirection(const vector<double>& oVec)
 {
     m_direction = oVec;
     normaliseToUnitBox(m_direction, m_ideal, m_antiIdeal);
-    toUnitVec(m_direction);
+    normalise<L2Norm>(m_direction.data(), m_direction.size());
 }
 
-void CODeMDistribution::defineIdealAndAntiIdeal(const vector<double> ideal,
-                                                const vector<double> antiIdeal)
+void CODeMDistribution::defineIdealAndAntiIdeal(const vector<double>& ideal,
+                                                const vector<double>& antiIdeal)
 {
     m_ideal = ideal;
     m_antiIdeal = antiIdeal;
 }
 void CODeMDistribution::defineDistribution(IDistribution* d)
 {
-    m_distribution = d;
+    if(d != m_distribution) {
+        delete m_distribution;
+        m_distribution = d;
+    }
+}
+
+IDistribution* CODeMDistribution::distribution() const
+{
+    return m_distribution;
+}
+
+void CODeMDistribution::defineRandomStream(RandomStream* stream)
+{
+    m_stream = stream;
+}
+
+RandomStream* CODeMDistribution::randomStream() const
+{
+    return m_stream;
 }
 
 } // namespace CODeM
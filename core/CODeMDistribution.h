@@ -17,33 +17,62 @@
 #define CODEMDISTRIBUTION_H
 
 #include <vector>
+#include <core/utils/NormKernels.h>
 
 class LinearInterpolator;
 
+namespace CODeM {
+class RandomStream;
+}
+
 namespace CODeM{
 
+// Owns its distribution: it is deleted with the CODeMDistribution, or when
+// another one is defined, and copies hold a clone.
 class CODeMDistribution
 {
 public:
+    // No distribution, the interval [0 1] and no direction perturbation.
+    // The define methods set it up before the first draw.
+    CODeMDistribution();
     CODeMDistribution(IDistribution* d,
-                      const vector<double> oVec,
+                      const vector<double>& oVec,
                       double lowerBound,
                       double upperBound,
-                      const vector<double> ideal,
-                      const vector<double> antiIdeal,
+                      const vector<double>& ideal,
+                      const vector<double>& antiIdeal,
                       double dirPertRad,
                       double dirPertNorm);
+    CODeMDistribution(const CODeMDistribution& cd);
+    CODeMDistribution& operator=(const CODeMDistribution& cd);
     ~CODeMDistribution();
 
     vector<double> sampleDistribution();
+    // Fills out with nSamp samples, stored row-major as nSamp x nObj().
+    // The draws are taken in a different order from nSamp calls of
+    // sampleDistribution(): first the nSamp values of the distribution,
+    // then the nSamp direction perturbations. The samples have the same
+    // distribution, and the same stream position gives the same batch, but
+    // not the same samples as the sequential calls.
+    void sampleDistribution(int nSamp, double* out);
+    int  nObj() const;
 
     void defineDirectionPertRadius(double r);
     void definePerturbationNorm(double p);
+    // the interval the distribution's values in [0 1] are scaled to
+    void defineBoundaries(double lowerBound, double upperBound);
     // 2-norm direction
-    void defineDirection(const vector<double> oVec);
-    void defineIdealAndAntiIdeal(const vector<double> ideal,
-                                 const vector<double> antiIdeal);
+    void defineDirection(const vector<double>& oVec);
+    void defineIdealAndAntiIdeal(const vector<double>& ideal,
+                                 const vector<double>& antiIdeal);
+    // Takes ownership of d, and deletes the previous distribution
     void defineDistribution(IDistribution* d);
+    // The owned distribution, which may be changed in place, or 0
+    IDistribution* distribution() const;
+    // Stream used for the draws; the current stream of the calling thread
+    // when not defined (or set to 0)
+    void defineRandomStream(RandomStream* stream);
+    RandomStream* randomStream() const;
 
 
 private:
@@ -55,6 +84,9 @@ private:
     double                m_lb;
     double                m_ub;
     double                m_pNorm;
+    // the kernel of m_pNorm, resolved when the norm is defined
+    NormType              m_normType;
+    RandomStream*         m_stream;
 };
 
 } //namespace CODeM
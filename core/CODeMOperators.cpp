@@ -14,9 +14,12 @@
 **
 ****************************************************************************/
 #include <core/CODeMOperators.h>
+#include <core/utils/RandomStream.h>
+#include <core/utils/NormKernels.h>
 #include <random>
-#include <tigon/Utils/NormalisationUtils.h>
-#include <qmath.h>
+#include <cmath>
+
+using namespace std;
 
 namespace CODeM {
 
@@ -27,53 +30,236 @@ double linearDecrease(double val)
 
 double skewedIncrease(double val, double alpha)
 {
-    return (alpha<0) ? 1.0 : qPow(val, alpha);
+    return (alpha<0) ? 1.0 : std::pow(val, alpha);
 }
 
 double skewedDecrease(double val, double alpha)
 {
-    return (alpha<0) ? 0.0 : 1.0 - qPow(val, alpha);
+    return (alpha<0) ? 0.0 : 1.0 - std::pow(val, alpha);
 }
 
 double lowOnValue(double val, double zeroVal, double width)
 {
-    double ret = 4.0 / qPow(width, 2.0) * qPow(val-zeroVal , 2.0);
+    double ret = 4.0 / std::pow(width, 2.0) * std::pow(val-zeroVal , 2.0);
     return (ret>1.0) ? 1.0 : ret;
 }
 
 double highOnValue(double val, double oneVal, double width)
 {
-    double ret = 1.0 - 4.0 / qPow(width, 2.0) * qPow(val-oneVal, 2.0);
+    double ret = 1.0 - 4.0 / std::pow(width, 2.0) * std::pow(val-oneVal, 2.0);
     return (ret<0.0) ? 0.0 : ret;
 }
 
 vector<double> directionPerturbation(const vector<double> oVec,
                                      double maxRadius, double pNorm)
 {
-    // project on the k-1 simplex
     vector<double> newObjVec(oVec);
-    toUnitVec(newObjVec, 1.0);
+    directionPerturbation(newObjVec.data(), 1, newObjVec.size(),
+                          maxRadius, pNorm);
+    return newObjVec;
+}
 
-    // calculate the p-distance
-    vector<double> vec(oVec);
-    double dist = magnitudeAndDirectionP(vec, pNorm);
+namespace {
+
+inline double exponentialVariate(RandomStream* rs)
+{
+    // 1-u is in (0,1]
+    return -std::log(1.0 - rs->randUni());
+}
+
+// Marsaglia and Tsang's method, with the a+1 boost for a < 1
+double gammaVariate(RandomStream* rs, double a)
+{
+    if(a < 1.0) {
+        double u = 1.0 - rs->randUni();
+        return gammaVariate(rs, a + 1.0) * std::pow(u, 1.0/a);
+    }
+    double d = a - 1.0/3.0;
+    double c = 1.0 / std::sqrt(9.0*d);
+    while(true) {
+        double x;
+        double v;
+        do {
+            rs->fillNormal(&x, 1);
+            v = 1.0 + c*x;
+        } while(v <= 0.0);
+        v = v*v*v;
+        double u = rs->randUni();
+        if(u < 1.0 - 0.0331*x*x*x*x) {
+            return d*v;
+        }
+        if(std::log(u) < 0.5*x*x + d*(1.0 - v + std::log(v))) {
+            return d*v;
+        }
+    }
+}
+
+// ball samples of directionPerturbation(), kept between calls up to
+// BallScratchMaxSize values
+const size_t BallScratchMaxSize = 1 << 16;
+thread_local vector<double> ballScratch;
+
+// directionPerturbation() of the rows of vecs, moved by the rows of ball
+// (or not at all when it is 0)
+template<NormType T>
+void perturbRows(double* vecs, int nSamp, int n, const double* ball,
+                 double pNorm)
+{
+    typedef NormKernel<T> Kernel;
+
+    for(int s=0; s<nSamp; s++) {
+        double* vec = vecs + (size_t)s*n;
+
+        // the 1-norm for the projection on the k-1 simplex, and the p-norm
+        // to scale back to
+        double sumAbs = 0.0;
+        double acc    = 0.0;
+        for(int i=0; i<n; i++) {
+            double a = std::abs(vec[i]);
+            sumAbs += a;
+            acc = Kernel::accumulate(acc, a, pNorm);
+        }
+        double dist = Kernel::finish(acc, pNorm);
+        double invSumAbs = (sumAbs > 0.0) ? 1.0/sumAbs : 1.0;
+
+        // project, perturb, and accumulate the p-norm of the result
+        double newAcc = 0.0;
+        if(ball != 0) {
+            const double* rd = ball + (size_t)s*n;
+            for(int i=0; i<n; i++) {
+                double v = vec[i]*invSumAbs + rd[i];
+                vec[i] = v;
+                newAcc = Kernel::accumulate(newAcc, std::abs(v), pNorm);
+            }
+        } else {
+            for(int i=0; i<n; i++) {
+                double v = vec[i]*invSumAbs;
+                vec[i] = v;
+                newAcc = Kernel::accumulate(newAcc, std::abs(v), pNorm);
+            }
+        }
+
+        // project on the p-norm unit sphere and scale back
+        double newDist = Kernel::finish(newAcc, pNorm);
+        double factor = (newDist > 0.0) ? dist/newDist : 0.0;
+        for(int i=0; i<n; i++) {
+            vec[i] *= factor;
+        }
+    }
+}
+
+// Scales each row g of out by radius / (|g|_p^p + w)^(1/p), w ~ Exp(1)
+template<NormType T>
+void scaleToBall(double* out, int nSamp, int n, double radius, double p,
+                 RandomStream* rs)
+{
+    typedef NormKernel<T> Kernel;
+
+    for(int s=0; s<nSamp; s++) {
+        double* x = out + (size_t)s*n;
+        double acc = 0.0;
+        for(int i=0; i<n; i++) {
+            acc = Kernel::accumulate(acc, std::abs(x[i]), p);
+        }
+        acc += exponentialVariate(rs);
+        double factor = radius / Kernel::finish(acc, p);
+        for(int i=0; i<n; i++) {
+            x[i] *= factor;
+        }
+    }
+}
+
+} // namespace
+
+void directionPerturbation(double* vecs, int nSamp, int n, double maxRadius,
+                           double pNorm, RandomStream* stream)
+{
+    directionPerturbation(vecs, nSamp, n, maxRadius, normType(pNorm), pNorm,
+                          stream);
+}
+
+void directionPerturbation(double* vecs, int nSamp, int n, double maxRadius,
+                           NormType type, double pNorm, RandomStream* stream)
+{
+    if(vecs == 0 || nSamp <= 0 || n <= 0) {
+        return;
+    }
+    if(type == LpNorm && !(pNorm > 0.0)) {
+        return;
+    }
+    RandomStream* rs = stream ? stream : currentRandomStream();
 
     // perturb within a sphere with r=maxRadius
-    double s = 0.0;
-    for(int i=0; i<newObjVec.size(); i++) {
-        double rd = TRAND.randUni(2.0, -1.0) *
-                qSqrt(maxRadius*maxRadius - s);
-        s += qPow(rd, 2.0);
-        newObjVec[i] += rd;
+    const double* ball = 0;
+    if(maxRadius > 0.0) {
+        ballScratch.resize((size_t)nSamp*n);
+        uniformBallSamples(ballScratch.data(), nSamp, n, maxRadius, 2.0, rs);
+        ball = ballScratch.data();
     }
 
-    // project on the p-norm unit sphere
-    toUnitVec(newObjVec, pNorm);
+    switch(type) {
+    case L1Norm:
+        perturbRows<L1Norm>(vecs, nSamp, n, ball, pNorm);
+        break;
+    case L2Norm:
+        perturbRows<L2Norm>(vecs, nSamp, n, ball, pNorm);
+        break;
+    case LInfNorm:
+        perturbRows<LInfNorm>(vecs, nSamp, n, ball, pNorm);
+        break;
+    default:
+        perturbRows<LpNorm>(vecs, nSamp, n, ball, pNorm);
+        break;
+    }
+
+    // release the samples of a large call rather than keep them per thread
+    if(ballScratch.capacity() > BallScratchMaxSize) {
+        vector<double>().swap(ballScratch);
+    }
+}
 
-    //scale back
-    scale(newObjVec, dist);
+void uniformBallSamples(double* out, int nSamp, int n, double radius,
+                        double p, RandomStream* stream)
+{
+    if(out == 0 || nSamp <= 0 || n <= 0 || p <= 0.0) {
+        return;
+    }
+    RandomStream* rs = stream ? stream : currentRandomStream();
+    size_t total = (size_t)nSamp*n;
 
-    return newObjVec;
+    // g_i with density c*exp(-|t|^p), scaled into the ball
+    switch(normType(p)) {
+    case L2Norm:
+        // exp(-t^2) is the normal density with variance 1/2; the scale
+        // cancels in g / |g|_2 but not against w, hence the std
+        rs->fillNormal(out, total, 0.0, std::sqrt(0.5));
+        scaleToBall<L2Norm>(out, nSamp, n, radius, p, rs);
+        break;
+    case L1Norm:
+        // Laplace variates
+        rs->fillUniform(out, total);
+        for(size_t i=0; i<total; i++) {
+            double e = -std::log(1.0 - out[i]);
+            out[i] = (rs->randUni() < 0.5) ? -e : e;
+        }
+        scaleToBall<L1Norm>(out, nSamp, n, radius, p, rs);
+        break;
+    case LInfNorm:
+        // the limit of the construction: the cube [-radius, radius]^n
+        rs->fillUniform(out, total);
+        for(size_t i=0; i<total; i++) {
+            out[i] = radius * (2.0*out[i] - 1.0);
+        }
+        break;
+    default:
+        // |g_i|^p is Gamma(1/p)
+        for(size_t i=0; i<total; i++) {
+            double t = std::pow(gammaVariate(rs, 1.0/p), 1.0/p);
+            out[i] = (rs->randUni() < 0.5) ? -t : t;
+        }
+        scaleToBall<LpNorm>(out, nSamp, n, radius, p, rs);
+        break;
+    }
 }
 
 } // namespace CODeM
@@ -20,8 +20,10 @@
 
 
 #include <vector>
+#include <core/utils/NormKernels.h>
 
 namespace CODeM {
+class RandomStream;
 
 // Relations between UncertaintyKernel properties and uncertainty parameters
 double linearDecrease(double val);
@@ -30,8 +32,32 @@ double skewedDecrease(double val, double alpha);
 double lowOnValue(double val, double zeroVal, double width);
 double highOnValue(double val, double oneVal, double width);
 
-vector<double> directionPerturbation(
-        const vector<double> oVec, double maxRadius, double pNorm=2);
+std::vector<double> directionPerturbation(
+        const std::vector<double> oVec, double maxRadius, double pNorm=2);
+
+// In-place directionPerturbation() of nSamp vectors of size n, stored
+// row-major in vecs (nSamp x n). Each vector is projected on the k-1
+// simplex, moved by a point drawn uniformly from the 2-norm ball of radius
+// maxRadius, and scaled to have the pNorm length of the original vector.
+// The projection and the rescaling are fused with the norm calculations.
+// The draws come from stream, or from the current stream of the calling
+// thread when it is 0.
+void directionPerturbation(double* vecs, int nSamp, int n, double maxRadius,
+                           double pNorm = 2, RandomStream* stream = 0);
+// As above, with the norm kernel already resolved by normType(pNorm)
+void directionPerturbation(double* vecs, int nSamp, int n, double maxRadius,
+                           NormType type, double pNorm,
+                           RandomStream* stream = 0);
+
+// nSamp points drawn uniformly from the p-ball {x : |x|_p <= radius} of
+// dimension n, written row-major (nSamp x n) to out. Uses the construction
+// of Barthe, Guedon, Mendelson and Naor: g / (|g|_p^p + w)^(1/p) is uniform
+// in the unit p-ball when the g_i have the density c*exp(-|t|^p) and w is
+// Exp(1). For p = 2 and p = 1 the g_i are normal and Laplace variates; any
+// other p > 0 draws them through a Gamma(1/p) variate. p = inf samples the
+// cube, the limit of the construction.
+void uniformBallSamples(double* out, int nSamp, int n, double radius,
+                        double p = 2, RandomStream* stream = 0);
 
 
 } // namespace CODeM
@@ -17,6 +17,9 @@
 #include <core/UncertaintyKernel.h>
 #include <core/CODeMOperators.h>
 #include <core/CODeMDistribution.h>
+#include <core/utils/RandomStream.h>
+#include <core/utils/NormKernels.h>
+#include <core/utils/ThreadPool.h>
 #include <core/Distributions/MergedDistribution.h>
 #include <core/Distributions/UniformDistribution.h>
 #include <core/Distributions/PeakDistribution.h>
@@ -26,43 +29,108 @@
 #include <tigon/Utils/NormalisationUtils.h>
 #include <libs/WFG/ExampleProblems.h>
 #include <libs/DTLZ/DTLZProblems.h>
+#include <atomic>
 
 using namespace WFGT::Toolkit::Examples::Problems;
 
 namespace CODeM {
 
-vector<double> CODeM1(vector<double> iVec, int k, int nObj)
+namespace {
 
+// The WFG based problems have the ideal at the origin and the anti-ideal at
+// scale*(1, 2, ..., nObj)
+void wfgIdealAndAntiIdeal(int nObj, double scale,
+                          vector<double>& ideal, vector<double>& antiIdeal)
 {
-    // Evaluate the decision vector
-    vector<double> oVec =
-            vector<double>::fromStdVector(WFG4(iVec.toStdVector(), k, nObj));
+    ideal.assign(nObj, 0.0);
+    antiIdeal.resize(nObj);
+    for(int i=0; i<nObj; i++) {
+        antiIdeal[i] = scale*(i+1);
+    }
+}
 
-    return CODeM1Perturb(oVec)[0];
+// DTLZ1 is modified so the 100 scale of the distance function
+// is not included
+double codem6MaxVal(int nVar)
+{
+    return 1.125 * nVar;
 }
 
-vector<vector<double> > CODeM1(vector<double> iVec,
-                                int k, int nObj, int nSamp)
+// The distribution of cd is changed in place when it has the type asked
+// for, and replaced otherwise, so a CODeMDistribution reused from one
+// individual to the next does not allocate once set up. A redefined
+// distribution draws the same values as a new one.
+void definePeak(CODeMDistribution& cd, double tendency, double locality)
 {
-    // Evaluate the decision vector
-    vector<double> oVec =
-            vector<double>::fromStdVector(WFG4(iVec.toStdVector(), k, nObj));
+    PeakDistribution* d = dynamic_cast<PeakDistribution*>(cd.distribution());
+    if(d == 0) {
+        cd.defineDistribution(new PeakDistribution(tendency, locality));
+    } else {
+        d->defineTendencyAndLocality(tendency, locality);
+    }
+}
 
-    return CODeM1Perturb(oVec, nSamp);
+void defineUniform(CODeMDistribution& cd, double lb, double ub)
+{
+    UniformDistribution* d =
+            dynamic_cast<UniformDistribution*>(cd.distribution());
+    if(d == 0) {
+        cd.defineDistribution(new UniformDistribution(lb, ub));
+    } else {
+        // as the constructor does
+        d->defineBoundaries(lb, ub);
+        d->defineResolution(d->upperBound() - d->lowerBound());
+    }
 }
 
-vector<vector<double> > CODeM1Perturb(vector<double> oVec, int nSamp)
+// An equal mixture of a uniform and a peak distribution
+void defineUniformAndPeak(CODeMDistribution& cd, double uniLB, double uniUB,
+                          double peakTend, double peakLoc)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3*(i+1);
+    MergedDistribution* d =
+            dynamic_cast<MergedDistribution*>(cd.distribution());
+    UniformDistribution* u = 0;
+    PeakDistribution*    p = 0;
+    if(d != 0 && d->nDistributions() == 2) {
+        u = dynamic_cast<UniformDistribution*>(d->distribution(0));
+        p = dynamic_cast<PeakDistribution*>(d->distribution(1));
+    }
+    if(u == 0 || p == 0) {
+        d = new MergedDistribution();
+        d->appendDistribution(new UniformDistribution(uniLB, uniUB), 0.5);
+        d->appendDistribution(new PeakDistribution(peakTend, peakLoc), 0.5);
+        cd.defineDistribution(d);
+        return;
     }
+    u->defineBoundaries(uniLB, uniUB);
+    u->defineResolution(u->upperBound() - u->lowerBound());
+    p->defineTendencyAndLocality(peakTend, peakLoc);
+    d->updateDistributions();
+}
+
+void defineShape(CODeMDistribution& cd, const vector<double>& oVec,
+                 double lb, double ub, const vector<double>& ideal,
+                 const vector<double>& antiIdeal, double dirPertRad,
+                 double distanceNorm)
+{
+    cd.defineBoundaries(lb, ub);
+    cd.defineIdealAndAntiIdeal(ideal, antiIdeal);
+    cd.defineDirection(oVec);
+    cd.defineDirectionPertRadius(dirPertRad);
+    cd.definePerturbationNorm(distanceNorm);
+}
+
+void defineCODeM1Distribution(CODeMDistribution& cd,
+                              const vector<double>& oVec,
+                              const vector<double>& ideal,
+                              const vector<double>& antiIdeal,
+                              const vector<double>& invRange)
+{
+    // Set the uncertainty kernel
     double lb = 2.0/3.0;
     double ub = 1.0;
 
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
+    UncertaintyKernelView uk(oVec, ideal, invRange, lb, ub);
 
     // Evaluate the uncertainty parameters
     double peakTend, peakLoc, dirPertRad;
@@ -74,11 +142,264 @@ vector<vector<double> > CODeM1Perturb(vector<double> oVec, int nSamp)
 
     dirPertRad = 0.0;
 
-    // Create the CODeM distribution
-    PeakDistribution* d = PeakDistribution*(
-                new PeakDistribution(peakTend, peakLoc));
+    // Define the CODeM distribution
+    definePeak(cd, peakTend, peakLoc);
+    defineShape(cd, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+}
+
+void defineCODeM2Distribution(CODeMDistribution& cd,
+                              const vector<double>& oVec,
+                              const vector<double>& ideal,
+                              const vector<double>& antiIdeal,
+                              const vector<double>& invRange)
+{
+    // Set the uncertainty kernel
+    double lb = 2.0/3.0;
+    double ub = 1.0;
+
+    UncertaintyKernelView uk(oVec, ideal, invRange, lb, ub);
+
+    // Evaluate the uncertainty parameters
+    double uniLB, uniUB, dirPertRad;
+
+    uniLB  = uk.proximity();
+    uniUB  = uniLB;
+
+    double distanceNorm = 2.0;
+
+    dirPertRad = 0.1 * uk.symmetry();
+
+    // Define the CODeM distribution
+    defineUniform(cd, uniLB, uniUB);
+    defineShape(cd, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+}
+
+void defineCODeM3Distribution(CODeMDistribution& cd,
+                              const vector<double>& oVec,
+                              const vector<double>& ideal,
+                              const vector<double>& antiIdeal,
+                              const vector<double>& invRange)
+{
+    // Set the uncertainty kernel
+    double lb = 2.0/3.0;
+    double ub = 1.0;
+
+
+    UncertaintyKernelView uk(oVec, ideal, invRange, lb, ub);
+
+    // Evaluate the uncertainty parameters
+    double uniLB, uniLoc, uniUB, peakTend, peakLoc, dirPertRad;
+
+    uniLB  = uk.proximity();
+    uniLoc = skewedDecrease(uk.proximity(), 1.5);
+    uniUB  = uniLB + (1-uniLoc) * (1.0-uniLB);
+
+    peakTend = uk.proximity();
+    peakLoc  = uk.symmetry();
+
+    double distanceNorm = 2.0;
+
+    dirPertRad = 0.04*lowOnValue(uk.oComponent(0), 0.45, 0.3);
+
+    // Define the CODeM distribution
+    defineUniformAndPeak(cd, uniLB, uniUB, peakTend, peakLoc);
+    defineShape(cd, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+}
+
+void defineCODeM4Distribution(CODeMDistribution& cd,
+                              const vector<double>& oVec,
+                              const vector<double>& ideal,
+                              const vector<double>& antiIdeal,
+                              const vector<double>& invRange)
+{
+    // Set the uncertainty kernel
+    double lb = 2.0/3.0;
+    double ub = 1.0;
+
+    UncertaintyKernelView uk(oVec, ideal, invRange, lb, ub);
+
+    // Evaluate the uncertainty parameters
+    double peakTend, peakLoc, dirPertRad;
+
+    peakTend = uk.proximity()+0.1;
+    peakLoc  = 0.8;
+
+    double distanceNorm = 2.0;
+
+    dirPertRad = 0.2*linearDecrease(uk.symmetry())+0.01;
+
+    // Define the CODeM distribution
+    definePeak(cd, peakTend, peakLoc);
+    defineShape(cd, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+}
+
+void defineCODeM5Distribution(CODeMDistribution& cd,
+                              const vector<double>& iVec,
+                              const vector<double>& oVec,
+                              const vector<double>& iLowerBounds,
+                                     const vector<double>& iInvRange,
+                                     const vector<double>& ideal,
+                              const vector<double>& antiIdeal,
+                              const vector<double>& invRange)
+{
+    // Set the uncertainty kernel
+    double lb = 2.0/4.0;
+    double ub = 1.0;
+
+    UncertaintyKernelView uk(iVec, iLowerBounds, iInvRange,
+                             oVec, ideal, invRange, lb, ub);
+
+    // Evaluate the uncertainty parameters
+    double uniLB, uniUB, uniLoc, dirPertRad;
+
+    uniLB  = uk.proximity();
+    uniLoc = linearDecrease(uk.dComponent(0));
+    uniUB  = uniLB + (1.0-uniLoc) * (1.0-uniLB);
+
+    double distanceNorm = 2.0;
+
+    dirPertRad = 0.1 * uk.dComponent(0);
+
+    // Define the CODeM distribution
+    defineUniform(cd, uniLB, uniUB);
+    defineShape(cd, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+}
+
+// lbFactor is 0.5 / the anti-ideal value
+void defineCODeM6Distribution(CODeMDistribution& cd,
+                              const vector<double>& oVec,
+                              const vector<double>& ideal,
+                              const vector<double>& antiIdeal,
+                              const vector<double>& invRange,
+                              double lbFactor)
+{
+    // Set the uncertainty kernel
+    // the 1-norm of the 2-norm direction
+    double sFactor = pNorm<L1Norm>(oVec.data(), oVec.size()) /
+                     pNorm<L2Norm>(oVec.data(), oVec.size());
+
+    double ub = 1.0 / sFactor;
+    double lb = lbFactor / sFactor;
+
+    UncertaintyKernelView uk(oVec, ideal, invRange, lb, ub);
+
+    // Evaluate the uncertainty parameters
+    double uniLB, uniUB, uniLoc, dirPertRad;
+
+    uniLB  = uk.proximity();
+    uniLoc = linearDecrease(uk.proximity()*uk.symmetry());
+    uniUB  = uniLB + (1.0-uniLoc) * (1.0-uniLB);
+
+    double distanceNorm = 1.0;
+
+    dirPertRad = 0.2 * uk.oComponent(0);
+
+    // Define the CODeM distribution
+    defineUniform(cd, uniLB, uniUB);
+    defineShape(cd, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+}
+
+// Lower bounds and inverse ranges of the decision space of problem prob
+void decisionBounds(int prob, int nVar,
+                    vector<double>& lowerBounds, vector<double>& invRange)
+{
+    BoxConstraintsData* box = createBoxConstraints(prob, nVar);
+    vector<double> upperBounds(nVar);
+    lowerBounds.resize(nVar);
+    for(int i=0; i<nVar; i++) {
+        lowerBounds[i] = box->lowerBounds().at(i).value<double>();
+        upperBounds[i] = box->upperBounds().at(i).value<double>();
+    }
+    delete box;
+    inverseRanges(lowerBounds, upperBounds, invRange);
+}
+
+// prob is 1-4
+CODeMDistribution CODeMxDistribution(int prob, const vector<double>& oVec)
+{
+    vector<double> ideal;
+    vector<double> antiIdeal;
+    vector<double> invRange;
+    wfgIdealAndAntiIdeal(oVec.size(), 3.0, ideal, antiIdeal);
+    inverseRanges(ideal, antiIdeal, invRange);
+
+    CODeMDistribution cd;
+    switch(prob) {
+    case 1:
+        defineCODeM1Distribution(cd, oVec, ideal, antiIdeal, invRange);
+        break;
+    case 2:
+        defineCODeM2Distribution(cd, oVec, ideal, antiIdeal, invRange);
+        break;
+    case 3:
+        defineCODeM3Distribution(cd, oVec, ideal, antiIdeal, invRange);
+        break;
+    default:
+        defineCODeM4Distribution(cd, oVec, ideal, antiIdeal, invRange);
+        break;
+    }
+    return cd;
+}
+
+CODeMDistribution CODeM5Distribution(const vector<double>& iVec,
+                                     const vector<double>& oVec)
+{
+    vector<double> ideal;
+    vector<double> antiIdeal;
+    vector<double> invRange;
+    wfgIdealAndAntiIdeal(oVec.size(), 4.0, ideal, antiIdeal);
+    inverseRanges(ideal, antiIdeal, invRange);
+
+    vector<double> iLowerBounds;
+    vector<double> iInvRange;
+    decisionBounds(5, iVec.size(), iLowerBounds, iInvRange);
+
+    CODeMDistribution cd;
+    defineCODeM5Distribution(cd, iVec, oVec, iLowerBounds, iInvRange,
+                             ideal, antiIdeal, invRange);
+    return cd;
+}
+
+CODeMDistribution CODeM6Distribution(const vector<double>& iVec,
+                                     const vector<double>& oVec)
+{
+    double maxVal = codem6MaxVal(iVec.size());
+    vector<double> ideal(oVec.size(), 0.0);
+    vector<double> antiIdeal(oVec.size(), maxVal);
+    vector<double> invRange;
+    inverseRanges(ideal, antiIdeal, invRange);
+
+    CODeMDistribution cd;
+    defineCODeM6Distribution(cd, oVec, ideal, antiIdeal, invRange,
+                             0.5 / maxVal);
+    return cd;
+}
+
+} // namespace
+
+vector<double> CODeM1(vector<double> iVec, int k, int nObj)
 
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+{
+    // Evaluate the decision vector
+    vector<double> oVec =
+            vector<double>::fromStdVector(WFG4(iVec.toStdVector(), k, nObj));
+
+    return CODeM1Perturb(oVec)[0];
+}
+
+vector<vector<double> > CODeM1(vector<double> iVec,
+                                int k, int nObj, int nSamp)
+{
+    // Evaluate the decision vector
+    vector<double> oVec =
+            vector<double>::fromStdVector(WFG4(iVec.toStdVector(), k, nObj));
+
+    return CODeM1Perturb(oVec, nSamp);
+}
+
+vector<vector<double> > CODeM1Perturb(vector<double> oVec, int nSamp)
+{
+    CODeMDistribution cd = CODeMxDistribution(1, oVec);
 
     // Sample the distribution
     vector<vector<double> > samples;
@@ -88,6 +409,14 @@ vector<vector<double> > CODeM1Perturb(vector<double> oVec, int nSamp)
     return samples;
 }
 
+void CODeM1Perturb(vector<double> oVec, int nSamp, double* samples,
+                   RandomStream* stream)
+{
+    CODeMDistribution cd = CODeMxDistribution(1, oVec);
+    cd.defineRandomStream(stream);
+    cd.sampleDistribution(nSamp, samples);
+}
+
 vector<double> CODeM2(vector<double> iVec, int k, int nObj)
 {
     // Evaluate the decision vector
@@ -109,32 +438,7 @@ vector<vector<double> > CODeM2(vector<double> iVec,
 
 vector<vector<double> > CODeM2Perturb(vector<double> oVec, int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3.0*(i+1);
-    }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniUB, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniUB  = uniLB;
-
-    double distanceNorm = 2.0;
-
-    dirPertRad = 0.1 * uk.symmetry();
-
-    // Create the CODeM distribution
-    UniformDistribution* d = UniformDistribution*(
-                new UniformDistribution(uniLB, uniUB));
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    CODeMDistribution cd = CODeMxDistribution(2, oVec);
 
     // Sample the distribution
     vector<vector<double> > samples;
@@ -144,6 +448,14 @@ vector<vector<double> > CODeM2Perturb(vector<double> oVec, int nSamp)
     return samples;
 }
 
+void CODeM2Perturb(vector<double> oVec, int nSamp, double* samples,
+                   RandomStream* stream)
+{
+    CODeMDistribution cd = CODeMxDistribution(2, oVec);
+    cd.defineRandomStream(stream);
+    cd.sampleDistribution(nSamp, samples);
+}
+
 vector<double> CODeM3(vector<double> iVec, int k, int nObj)
 {
     // Evaluate the decision vector
@@ -165,40 +477,7 @@ vector<vector<double> > CODeM3(vector<double> iVec,
 
 vector<vector<double> > CODeM3Perturb(vector<double> oVec, int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3.0*(i+1);
-    }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
-
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniLoc, uniUB, peakTend, peakLoc, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniLoc = skewedDecrease(uk.proximity(), 1.5);
-    uniUB  = uniLB + (1-uniLoc) * (1.0-uniLB);
-
-    peakTend = uk.proximity();
-    peakLoc  = uk.symmetry();
-
-    double distanceNorm = 2.0;
-
-    dirPertRad = 0.04*lowOnValue(uk.oComponent(0), 0.45, 0.3);
-
-    // Create the CODeM distribution
-    MergedDistribution* d = MergedDistribution*::create();
-    d->appendDistribution(UniformDistribution*(
-                              new UniformDistribution(uniLB, uniUB)), 0.5);
-    d->appendDistribution(PeakDistribution*(
-                              new PeakDistribution(peakTend, peakLoc)), 0.5);
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    CODeMDistribution cd = CODeMxDistribution(3, oVec);
 
     // Sample the distribution
     vector<vector<double> > samples;
@@ -208,6 +487,14 @@ vector<vector<double> > CODeM3Perturb(vector<double> oVec, int nSamp)
     return samples;
 }
 
+void CODeM3Perturb(vector<double> oVec, int nSamp, double* samples,
+                   RandomStream* stream)
+{
+    CODeMDistribution cd = CODeMxDistribution(3, oVec);
+    cd.defineRandomStream(stream);
+    cd.sampleDistribution(nSamp, samples);
+}
+
 vector<double> CODeM4(vector<double> iVec, int k, int nObj)
 {
     // Evaluate the decision vector
@@ -229,32 +516,7 @@ vector<vector<double> > CODeM4(vector<double> iVec,
 
 vector<vector<double> > CODeM4Perturb(vector<double> oVec, int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3.0*(i+1);
-    }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double peakTend, peakLoc, dirPertRad;
-
-    peakTend = uk.proximity()+0.1;
-    peakLoc  = 0.8;
-
-    double distanceNorm = 2.0;
-
-    dirPertRad = 0.2*linearDecrease(uk.symmetry())+0.01;
-
-    // Create the CODeM distribution
-    PeakDistribution* d = PeakDistribution*(
-                new PeakDistribution(peakTend, peakLoc));
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    CODeMDistribution cd = CODeMxDistribution(4, oVec);
 
     // Sample the distribution
     vector<vector<double> > samples;
@@ -264,6 +526,14 @@ vector<vector<double> > CODeM4Perturb(vector<double> oVec, int nSamp)
     return samples;
 }
 
+void CODeM4Perturb(vector<double> oVec, int nSamp, double* samples,
+                   RandomStream* stream)
+{
+    CODeMDistribution cd = CODeMxDistribution(4, oVec);
+    cd.defineRandomStream(stream);
+    cd.sampleDistribution(nSamp, samples);
+}
+
 vector<double> CODeM5(vector<double> iVec, int k, int nObj)
 {
     // Evaluate the decision vector
@@ -287,35 +557,7 @@ vector<vector<double> > CODeM5Perturb(vector<double> iVec,
                                        vector<double> oVec,
                                        int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 4.0*(i+1);
-    }
-    double lb = 2.0/4.0;
-    double ub = 1.0;
-
-    BoxConstraintsData* box = createBoxConstraints(5, iVec.size());
-
-    UncertaintyKernel uk(iVec, oVec, box, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniUB, uniLoc, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniLoc = linearDecrease(uk.dComponent(0));
-    uniUB  = uniLB + (1.0-uniLoc) * (1.0-uniLB);
-
-    double distanceNorm = 2.0;
-
-    dirPertRad = 0.1 * uk.dComponent(0);
-
-    // Create the CODeM distribution
-    UniformDistribution* d = UniformDistribution*(
-                new UniformDistribution(uniLB, uniUB));
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    CODeMDistribution cd = CODeM5Distribution(iVec, oVec);
 
     // Sample the distribution
     vector<vector<double> > samples;
@@ -325,6 +567,15 @@ vector<vector<double> > CODeM5Perturb(vector<double> iVec,
     return samples;
 }
 
+void CODeM5Perturb(vector<double> iVec, vector<double> oVec,
+                   int nSamp, double* samples,
+                   RandomStream* stream)
+{
+    CODeMDistribution cd = CODeM5Distribution(iVec, oVec);
+    cd.defineRandomStream(stream);
+    cd.sampleDistribution(nSamp, samples);
+}
+
 vector<double> CODeM6(vector<double> iVec, int nObj)
 {
     // Evaluate the decision vector
@@ -345,39 +596,7 @@ vector<vector<double> > CODeM6(vector<double> iVec,
 vector<vector<double> > CODeM6Perturb(vector<double> iVec, vector<double> oVec,
                                        int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-
-    // DTLZ1 is modified so the 100 scale of the distance function
-    // is not included
-    double maxVal = 1.125 * iVec.size();
-    vector<double> antiIdeal(oVec.size(), maxVal);
-
-    vector<double> normVec(oVec);
-    toUnitVec(normVec, 2.0);
-    double sFactor = magnitudeAndDirectionP(normVec, 1);
-
-    double ub = 1.0 / sFactor;
-    double lb = 0.5 / maxVal / sFactor;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniUB, uniLoc, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniLoc = linearDecrease(uk.proximity()*uk.symmetry());
-    uniUB  = uniLB + (1.0-uniLoc) * (1.0-uniLB);
-
-    double distanceNorm = 1.0;
-
-    dirPertRad = 0.2 * uk.oComponent(0);
-
-    // Create the CODeM distribution
-    UniformDistribution* d = UniformDistribution*(
-                new UniformDistribution(uniLB, uniUB));
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    CODeMDistribution cd = CODeM6Distribution(iVec, oVec);
 
     // Sample the distribution
     vector<vector<double> > samples;
@@ -387,6 +606,15 @@ vector<vector<double> > CODeM6Perturb(vector<double> iVec, vector<double> oVec,
     return samples;
 }
 
+void CODeM6Perturb(vector<double> iVec, vector<double> oVec,
+                   int nSamp, double* samples,
+                   RandomStream* stream)
+{
+    CODeMDistribution cd = CODeM6Distribution(iVec, oVec);
+    cd.defineRandomStream(stream);
+    cd.sampleDistribution(nSamp, samples);
+}
+
 vector<double> deterministicOVec(int prob, vector<double> iVec, int nObj, int k)
 {
     vector<double> oVec;
@@ -414,6 +642,45 @@ vector<double> deterministicOVec(int prob, vector<double> iVec, int nObj, int k)
     return oVec;
 }
 
+bool evaluatePopulation(int prob, const double* X, int nInd, int nVar,
+                        int k, int nObj, int nSamp, double* out,
+                        uint64_t seed, ThreadPool* pool)
+{
+    if(prob < 1 || prob > 6 || X == 0 || out == 0 || nInd <= 0) {
+        return false;
+    }
+    if(pool == 0) {
+        pool = ThreadPool::globalInstance();
+    }
+
+    // the problem constants are shared by all the individuals
+    CODeMProblem* problem = createCODeMProblem(prob, nVar, k, nObj);
+
+    // per-thread scratch: the decision vector, the random stream and the
+    // distribution, which is redefined for every individual
+    int nThreads = pool->nThreads();
+    vector<vector<double> >   iVecs(nThreads, vector<double>(nVar));
+    vector<RandomStream>      streams(nThreads);
+    vector<CODeMDistribution> distributions(nThreads);
+    std::atomic<bool>         allEvaluated(true);
+
+    pool->parallelFor(nInd, [&](int i, int worker) {
+        vector<double>& iVec = iVecs[worker];
+        iVec.assign(X + i*nVar, X + (i+1)*nVar);
+
+        RandomStream& stream = streams[worker];
+        stream.defineStream(seed, i);
+
+        if(!problem->evaluate(iVec, nSamp, out + (size_t)i*nSamp*nObj,
+                              &stream, distributions[worker])) {
+            allEvaluated = false;
+        }
+    });
+
+    delete problem;
+    return allEvaluated;
+}
+
 BoxConstraintsData* createBoxConstraints(int prob, int nVar)
 {
     vector<IElement> lowerBounds;
@@ -449,4 +716,214 @@ BoxConstraintsData* createBoxConstraints(int prob, int nVar)
     return box;
 }
 
+CODeMProblem::CODeMProblem(int prob, int nVar, int k, int nObj)
+    : m_prob(prob),
+      m_nVar(nVar),
+      m_k(k),
+      m_nObj(nObj)
+{
+
+}
+
+CODeMProblem::~CODeMProblem()
+{
+
+}
+
+int CODeMProblem::prob() const
+{
+    return m_prob;
+}
+
+int CODeMProblem::nVar() const
+{
+    return m_nVar;
+}
+
+int CODeMProblem::k() const
+{
+    return m_k;
+}
+
+int CODeMProblem::nObj() const
+{
+    return m_nObj;
+}
+
+const vector<double>& CODeMProblem::ideal() const
+{
+    return m_ideal;
+}
+
+const vector<double>& CODeMProblem::antiIdeal() const
+{
+    return m_antiIdeal;
+}
+
+vector<double> CODeMProblem::evaluate(const vector<double>& iVec) const
+{
+    return deterministicOVec(m_prob, iVec, m_nObj, m_k);
+}
+
+bool CODeMProblem::evaluate(const vector<double>& iVec, int nSamp,
+                            double* samples, RandomStream* stream) const
+{
+    return perturb(iVec, evaluate(iVec), nSamp, samples, stream);
+}
+
+bool CODeMProblem::evaluate(const vector<double>& iVec, int nSamp,
+                            double* samples, RandomStream* stream,
+                            CODeMDistribution& cd) const
+{
+    return perturb(iVec, evaluate(iVec), nSamp, samples, stream, cd);
+}
+
+vector<vector<double> > CODeMProblem::perturb(const vector<double>& iVec,
+                                               const vector<double>& oVec,
+                                               int nSamp) const
+{
+    CODeMDistribution cd;
+    defineDistribution(cd, iVec, oVec);
+
+    // Sample the distribution
+    vector<vector<double> > samples;
+    for(int i=0; i<nSamp; i++) {
+        samples.append(cd.sampleDistribution());
+    }
+    return samples;
+}
+
+bool CODeMProblem::perturb(const vector<double>& iVec,
+                           const vector<double>& oVec,
+                           int nSamp, double* samples,
+                           RandomStream* stream) const
+{
+    CODeMDistribution cd;
+    return perturb(iVec, oVec, nSamp, samples, stream, cd);
+}
+
+bool CODeMProblem::perturb(const vector<double>& iVec,
+                           const vector<double>& oVec,
+                           int nSamp, double* samples,
+                           RandomStream* stream, CODeMDistribution& cd) const
+{
+    if(oVec.size() != m_nObj) {
+        return false;
+    }
+    defineDistribution(cd, iVec, oVec);
+    cd.defineRandomStream(stream);
+    cd.sampleDistribution(nSamp, samples);
+    return true;
+}
+
+CODeM1Problem::CODeM1Problem(int nVar, int k, int nObj)
+    : CODeMProblem(1, nVar, k, nObj)
+{
+    wfgIdealAndAntiIdeal(nObj, 3.0, m_ideal, m_antiIdeal);
+    inverseRanges(m_ideal, m_antiIdeal, m_invRange);
+}
+
+void CODeM1Problem::defineDistribution(CODeMDistribution& cd,
+                                       const vector<double>& iVec,
+                                       const vector<double>& oVec) const
+{
+    defineCODeM1Distribution(cd, oVec, m_ideal, m_antiIdeal, m_invRange);
+}
+
+CODeM2Problem::CODeM2Problem(int nVar, int k, int nObj)
+    : CODeMProblem(2, nVar, k, nObj)
+{
+    wfgIdealAndAntiIdeal(nObj, 3.0, m_ideal, m_antiIdeal);
+    inverseRanges(m_ideal, m_antiIdeal, m_invRange);
+}
+
+void CODeM2Problem::defineDistribution(CODeMDistribution& cd,
+                                       const vector<double>& iVec,
+                                       const vector<double>& oVec) const
+{
+    defineCODeM2Distribution(cd, oVec, m_ideal, m_antiIdeal, m_invRange);
+}
+
+CODeM3Problem::CODeM3Problem(int nVar, int k, int nObj)
+    : CODeMProblem(3, nVar, k, nObj)
+{
+    wfgIdealAndAntiIdeal(nObj, 3.0, m_ideal, m_antiIdeal);
+    inverseRanges(m_ideal, m_antiIdeal, m_invRange);
+}
+
+void CODeM3Problem::defineDistribution(CODeMDistribution& cd,
+                                       const vector<double>& iVec,
+                                       const vector<double>& oVec) const
+{
+    defineCODeM3Distribution(cd, oVec, m_ideal, m_antiIdeal, m_invRange);
+}
+
+CODeM4Problem::CODeM4Problem(int nVar, int k, int nObj)
+    : CODeMProblem(4, nVar, k, nObj)
+{
+    wfgIdealAndAntiIdeal(nObj, 3.0, m_ideal, m_antiIdeal);
+    inverseRanges(m_ideal, m_antiIdeal, m_invRange);
+}
+
+void CODeM4Problem::defineDistribution(CODeMDistribution& cd,
+                                       const vector<double>& iVec,
+                                       const vector<double>& oVec) const
+{
+    defineCODeM4Distribution(cd, oVec, m_ideal, m_antiIdeal, m_invRange);
+}
+
+CODeM5Problem::CODeM5Problem(int nVar, int k, int nObj)
+    : CODeMProblem(5, nVar, k, nObj)
+{
+    wfgIdealAndAntiIdeal(nObj, 4.0, m_ideal, m_antiIdeal);
+    inverseRanges(m_ideal, m_antiIdeal, m_invRange);
+    decisionBounds(5, nVar, m_iLowerBounds, m_iInvRange);
+}
+
+void CODeM5Problem::defineDistribution(CODeMDistribution& cd,
+                                       const vector<double>& iVec,
+                                       const vector<double>& oVec) const
+{
+    defineCODeM5Distribution(cd, iVec, oVec, m_iLowerBounds, m_iInvRange,
+                             m_ideal, m_antiIdeal, m_invRange);
+}
+
+CODeM6Problem::CODeM6Problem(int nVar, int nObj)
+    : CODeMProblem(6, nVar, 0, nObj)
+{
+    double maxVal = codem6MaxVal(nVar);
+    m_ideal.assign(nObj, 0.0);
+    m_antiIdeal.assign(nObj, maxVal);
+    inverseRanges(m_ideal, m_antiIdeal, m_invRange);
+    m_lbFactor = 0.5 / maxVal;
+}
+
+void CODeM6Problem::defineDistribution(CODeMDistribution& cd,
+                                       const vector<double>& iVec,
+                                       const vector<double>& oVec) const
+{
+    defineCODeM6Distribution(cd, oVec, m_ideal, m_antiIdeal, m_invRange,
+                             m_lbFactor);
+}
+
+CODeMProblem* createCODeMProblem(int prob, int nVar, int k, int nObj)
+{
+    switch(prob) {
+    case 1:
+        return new CODeM1Problem(nVar, k, nObj);
+    case 2:
+        return new CODeM2Problem(nVar, k, nObj);
+    case 3:
+        return new CODeM3Problem(nVar, k, nObj);
+    case 4:
+        return new CODeM4Problem(nVar, k, nObj);
+    case 5:
+        return new CODeM5Problem(nVar, k, nObj);
+    case 6:
+        return new CODeM6Problem(nVar, nObj);
+    default:
+        return 0;
+    }
+}
+
 } // namespace CODeM
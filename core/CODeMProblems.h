@@ -20,8 +20,20 @@
 
 
 #include <vector>
+#include <cstdint>
+class BoxConstraintsData;
 
 namespace CODeM {
+class RandomStream;
+class ThreadPool;
+class CODeMDistribution;
+
+// The CODeMxPerturb overloads taking a samples pointer write nSamp
+// objective vectors into a caller-allocated nSamp x nObj row-major buffer.
+// The draws come from stream, or from the current stream of the calling
+// thread when it is 0. They are taken in the order of
+// CODeMDistribution::sampleDistribution(nSamp, out), so a seed gives other
+// samples than the vector-of-vectors overloads.
 
 vector<double>           CODeM1(vector<double> iVec,
                                                    int k, int nObj);
@@ -29,6 +41,9 @@ vector<vector<double> > CODeM1(vector<double> iVec,
                                                    int k, int nObj, int nSamp);
 vector<vector<double> > CODeM1Perturb(vector<double> oVec,
                                                           int nSamp = 1);
+void                     CODeM1Perturb(vector<double> oVec,
+                                                   int nSamp, double* samples,
+                                                   RandomStream* stream = 0);
 
 vector<double>           CODeM2(vector<double> iVec,
                                                    int k, int nObj);
@@ -36,6 +51,9 @@ vector<vector<double> > CODeM2(vector<double> iVec,
                                                    int k, int nObj, int nSamp);
 vector<vector<double> > CODeM2Perturb(vector<double> oVec,
                                                           int nSamp = 1);
+void                     CODeM2Perturb(vector<double> oVec,
+                                                   int nSamp, double* samples,
+                                                   RandomStream* stream = 0);
 
 vector<double>           CODeM3(vector<double> iVec,
                                                    int k, int nObj);
@@ -43,6 +61,9 @@ vector<vector<double> > CODeM3(vector<double> iVec,
                                                    int k, int nObj, int nSamp);
 vector<vector<double> > CODeM3Perturb(vector<double> oVec,
                                                           int nSamp = 1);
+void                     CODeM3Perturb(vector<double> oVec,
+                                                   int nSamp, double* samples,
+                                                   RandomStream* stream = 0);
 
 vector<double>           CODeM4(vector<double> iVec,
                                                    int k, int nObj);
@@ -50,6 +71,9 @@ vector<vector<double> > CODeM4(vector<double> iVec,
                                                    int k, int nObj, int nSamp);
 vector<vector<double> > CODeM4Perturb(vector<double> oVec,
                                                           int nSamp = 1);
+void                     CODeM4Perturb(vector<double> oVec,
+                                                   int nSamp, double* samples,
+                                                   RandomStream* stream = 0);
 
 // CODeM5Perturb must have both decision and objective vectors defined
 vector<double>           CODeM5(vector<double> iVec,
@@ -59,6 +83,10 @@ vector<vector<double> > CODeM5(vector<double> iVec,
 vector<vector<double> > CODeM5Perturb(vector<double> iVec,
                                                           vector<double> oVec,
                                                           int nSamp = 1);
+void                     CODeM5Perturb(vector<double> iVec,
+                                                   vector<double> oVec,
+                                                   int nSamp, double* samples,
+                                                   RandomStream* stream = 0);
 
 vector<double>           CODeM6(vector<double> iVec,
                                                    int nObj);
@@ -67,12 +95,171 @@ vector<vector<double> > CODeM6(vector<double> iVec,
 vector<vector<double> > CODeM6Perturb(vector<double> iVec,
                                                           vector<double> oVec,
                                                           int nSamp = 1);
+void                     CODeM6Perturb(vector<double> iVec,
+                                                   vector<double> oVec,
+                                                   int nSamp, double* samples,
+                                                   RandomStream* stream = 0);
 
 vector<double> deterministicOVec(int prob,
                                                     vector<double> iVec,
                                                     int nObj, int k=0);
 
 BoxConstraintsData* createBoxConstraints(int prob, int nVar);
+
+// Evaluates a population of nInd decision vectors, stored row-major in X
+// (nInd x nVar), for CODeM problem prob (1-6; k is ignored by CODeM6).
+// out receives nSamp objective vectors per individual, nInd x nSamp x nObj.
+// Individuals are spread over the threads of pool (the global pool when
+// 0). Individual i draws from stream (seed, i), so the output does not
+// depend on the number of threads. Each worker reuses its decision vector,
+// random stream and CODeMDistribution, whose distribution is redefined in
+// place for every individual. Returns false, and leaves out untouched,
+// for invalid arguments; returns false also when an individual could not
+// be evaluated, whose samples are then left unwritten.
+bool evaluatePopulation(int prob, const double* X, int nInd, int nVar,
+                        int k, int nObj, int nSamp, double* out,
+                        uint64_t seed = 0, ThreadPool* pool = 0);
+
+// A CODeM problem set up once for a number of decision variables, position
+// parameters k and objectives. The ideal and anti-ideal vectors, the
+// decision variable bounds and the inverse ranges used by the uncertainty
+// kernel are computed by the constructor and reused by every evaluation.
+// The const methods may be called from several threads at once.
+class CODeMProblem
+{
+public:
+    virtual ~CODeMProblem();
+
+    int prob()  const;
+    int nVar()  const;
+    int k()     const;
+    int nObj()  const;
+    const vector<double>& ideal()     const;
+    const vector<double>& antiIdeal() const;
+
+    // Deterministic objective vector of iVec
+    vector<double> evaluate(const vector<double>& iVec) const;
+    // nSamp perturbed objective vectors of iVec, written row-major
+    // (nSamp x nObj) to samples
+    bool evaluate(const vector<double>& iVec, int nSamp, double* samples,
+                  RandomStream* stream = 0) const;
+    // The same, drawing through cd, whose distribution objects are reused
+    // from one call to the next when they have the right type
+    bool evaluate(const vector<double>& iVec, int nSamp, double* samples,
+                  RandomStream* stream, CODeMDistribution& cd) const;
+
+    // Perturbations of oVec, the objective vector of iVec. The buffer
+    // version returns false, and leaves samples untouched, when oVec does
+    // not have nObj() objectives.
+    vector<vector<double> > perturb(const vector<double>& iVec,
+                                     const vector<double>& oVec,
+                                     int nSamp = 1) const;
+    bool perturb(const vector<double>& iVec, const vector<double>& oVec,
+                 int nSamp, double* samples, RandomStream* stream = 0) const;
+    bool perturb(const vector<double>& iVec, const vector<double>& oVec,
+                 int nSamp, double* samples, RandomStream* stream,
+                 CODeMDistribution& cd) const;
+
+protected:
+    CODeMProblem(int prob, int nVar, int k, int nObj);
+
+    // Sets cd up for iVec and oVec, reusing its distribution when it can
+    virtual void defineDistribution(CODeMDistribution& cd,
+                                    const vector<double>& iVec,
+                                    const vector<double>& oVec) const = 0;
+
+    int               m_prob;
+    int               m_nVar;
+    int               m_k;
+    int               m_nObj;
+    vector<double>    m_ideal;
+    vector<double>    m_antiIdeal;
+    // 1/(antiIdeal-ideal)
+    vector<double>    m_invRange;
+
+private:
+    CODeMProblem(const CODeMProblem&);
+    CODeMProblem& operator=(const CODeMProblem&);
+};
+
+class CODeM1Problem : public CODeMProblem
+{
+public:
+    CODeM1Problem(int nVar, int k, int nObj);
+
+protected:
+    void defineDistribution(CODeMDistribution& cd,
+                            const vector<double>& iVec,
+                            const vector<double>& oVec) const;
+};
+
+class CODeM2Problem : public CODeMProblem
+{
+public:
+    CODeM2Problem(int nVar, int k, int nObj);
+
+protected:
+    void defineDistribution(CODeMDistribution& cd,
+                            const vector<double>& iVec,
+                            const vector<double>& oVec) const;
+};
+
+class CODeM3Problem : public CODeMProblem
+{
+public:
+    CODeM3Problem(int nVar, int k, int nObj);
+
+protected:
+    void defineDistribution(CODeMDistribution& cd,
+                            const vector<double>& iVec,
+                            const vector<double>& oVec) const;
+};
+
+class CODeM4Problem : public CODeMProblem
+{
+public:
+    CODeM4Problem(int nVar, int k, int nObj);
+
+protected:
+    void defineDistribution(CODeMDistribution& cd,
+                            const vector<double>& iVec,
+                            const vector<double>& oVec) const;
+};
+
+class CODeM5Problem : public CODeMProblem
+{
+public:
+    CODeM5Problem(int nVar, int k, int nObj);
+
+protected:
+    void defineDistribution(CODeMDistribution& cd,
+                            const vector<double>& iVec,
+                            const vector<double>& oVec) const;
+
+private:
+    // lower bounds and 1/(ub-lb) of the decision variables
+    vector<double> m_iLowerBounds;
+    vector<double> m_iInvRange;
+};
+
+// k is not used by CODeM6
+class CODeM6Problem : public CODeMProblem
+{
+public:
+    CODeM6Problem(int nVar, int nObj);
+
+protected:
+    void defineDistribution(CODeMDistribution& cd,
+                            const vector<double>& iVec,
+                            const vector<double>& oVec) const;
+
+private:
+    // 0.5 / the anti-ideal value
+    double m_lbFactor;
+};
+
+// CODeMxProblem for prob in 1-6, or 0
+CODeMProblem* createCODeMProblem(int prob, int nVar, int k, int nObj);
 } // namespace CODeM
 
 #endif // CODEMPROBLEMS_H
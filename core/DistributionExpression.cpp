@@ -0,0 +1,308 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#include <core/DistributionExpression.h>
+#include <core/RandomDistributions.h>
+#include <map>
+#include <vector>
+
+namespace CODeM {
+
+struct DistributionExpression::Node
+{
+    enum Operation {
+        Leaf,
+        Add,
+        Multiply,
+        Divide,
+        Reciprocal,
+        // scale*lhs + shift
+        Affine
+    };
+
+    Operation              op;
+    IDistribution*         leaf;
+    shared_ptr<const Node> lhs;
+    shared_ptr<const Node> rhs;
+    double                 scale;
+    double                 shift;
+};
+
+namespace {
+
+typedef DistributionExpression::Node Node;
+typedef map<const Node*, IDistribution*> ResultMap;
+typedef map<const Node*, int>            CountMap;
+
+shared_ptr<const Node> makeNode(Node::Operation op,
+                                shared_ptr<const Node> lhs,
+                                shared_ptr<const Node> rhs,
+                                double scale = 1.0,
+                                double shift = 0.0)
+{
+    Node* node  = new Node;
+    node->op    = op;
+    node->leaf  = 0;
+    node->lhs   = lhs;
+    node->rhs   = rhs;
+    node->scale = scale;
+    node->shift = shift;
+    return shared_ptr<const Node>(node);
+}
+
+// Counts how many times each node is referenced within the expression
+void countReferences(const Node* node, CountMap& counts)
+{
+    if(node == 0) {
+        return;
+    }
+    if(++counts[node] > 1) {
+        return;
+    }
+    countReferences(node->lhs.get(), counts);
+    countReferences(node->rhs.get(), counts);
+}
+
+// The terms of the sum at node. Nested sums are expanded unless they are
+// shared, since those are evaluated once and reused.
+void collectTerms(const Node* node, const CountMap& counts,
+                  vector<const Node*>& terms)
+{
+    for(int i=0; i<2; i++) {
+        const Node* term = (i == 0) ? node->lhs.get() : node->rhs.get();
+        if(term->op == Node::Add && counts.find(term)->second == 1) {
+            collectTerms(term, counts, terms);
+        } else {
+            terms.push_back(term);
+        }
+    }
+}
+
+// Returns a new distribution for node; shared sub-expressions are
+// evaluated once and copied for every further use. The leaves are in
+// results from the start.
+IDistribution* evaluateNode(const Node* node, const CountMap& counts,
+                            ResultMap& results)
+{
+    ResultMap::iterator it = results.find(node);
+    if(it != results.end()) {
+        return it->second->clone();
+    }
+
+    IDistribution* d = 0;
+    switch(node->op) {
+    case Node::Affine:
+        d = evaluateNode(node->lhs.get(), counts, results);
+        d->affineTransform(node->scale, node->shift);
+        break;
+
+    case Node::Reciprocal:
+        d = evaluateNode(node->lhs.get(), counts, results);
+        d->reciprocal();
+        break;
+
+    case Node::Add:
+    {
+        // a chain of sums is a single convolution of all its terms
+        vector<const Node*> terms;
+        collectTerms(node, counts, terms);
+        d = evaluateNode(terms[0], counts, results);
+        vector<const IDistribution*> others(terms.size()-1);
+        for(int i=1; i<terms.size(); i++) {
+            others[i-1] = evaluateNode(terms[i], counts, results);
+        }
+        d->add(others);
+        for(int i=0; i<others.size(); i++) {
+            delete others[i];
+        }
+        break;
+    }
+    case Node::Multiply:
+    case Node::Divide:
+    {
+        d = evaluateNode(node->lhs.get(), counts, results);
+        IDistribution* other =
+                evaluateNode(node->rhs.get(), counts, results);
+        if(node->op == Node::Multiply) {
+            d->multiply(other);
+        } else {
+            d->divide(other);
+        }
+        delete other;
+        break;
+    }
+    default:
+        break;
+    }
+
+    if(counts.find(node)->second > 1) {
+        results[node] = d->clone();
+    }
+    return d;
+}
+
+} // namespace
+
+DistributionExpression::DistributionExpression(IDistribution* d)
+{
+    Node* node  = new Node;
+    node->op    = Node::Leaf;
+    node->leaf  = d;
+    node->scale = 1.0;
+    node->shift = 0.0;
+    m_node = shared_ptr<const Node>(node);
+}
+
+DistributionExpression::DistributionExpression(shared_ptr<const Node> node)
+    : m_node(node)
+{
+
+}
+
+IDistribution* DistributionExpression::evaluate(int nSamples) const
+{
+    CountMap counts;
+    countReferences(m_node.get(), counts);
+
+    // an invalid leaf makes the whole expression invalid
+    for(CountMap::iterator it = counts.begin(); it != counts.end(); ++it) {
+        if(it->first->op == Node::Leaf && it->first->leaf == 0) {
+            return 0;
+        }
+    }
+
+    // Deferred copies of the leaves, on their grids rather than their
+    // closed forms. Deferral stays inside the evaluation: only the result
+    // leaves it, normalised.
+    ResultMap results;
+    for(CountMap::iterator it = counts.begin(); it != counts.end(); ++it) {
+        if(it->first->op == Node::Leaf) {
+            IDistribution* leaf = it->first->leaf;
+            leaf->pdf();
+            IDistribution* d = new IDistribution(*leaf);
+            d->defineDeferredCDF(true);
+            results[it->first] = d;
+        }
+    }
+
+    IDistribution* d = evaluateNode(m_node.get(), counts, results);
+    for(ResultMap::iterator it = results.begin(); it != results.end(); ++it) {
+        delete it->second;
+    }
+
+    if(nSamples > 1) {
+        d->resample(nSamples);
+    }
+    // normalise and build the cdf of the final result only
+    d->defineDeferredCDF(false);
+    return d;
+}
+
+DistributionExpression operator+(const DistributionExpression& a,
+                                 const DistributionExpression& b)
+{
+    return DistributionExpression(makeNode(Node::Add, a.m_node, b.m_node));
+}
+
+DistributionExpression operator-(const DistributionExpression& a,
+                                 const DistributionExpression& b)
+{
+    return a + affine(b, -1.0, 0.0);
+}
+
+DistributionExpression operator*(const DistributionExpression& a,
+                                 const DistributionExpression& b)
+{
+    return DistributionExpression(makeNode(Node::Multiply,
+                                           a.m_node, b.m_node));
+}
+
+DistributionExpression operator/(const DistributionExpression& a,
+                                 const DistributionExpression& b)
+{
+    return DistributionExpression(makeNode(Node::Divide, a.m_node, b.m_node));
+}
+
+DistributionExpression reciprocal(const DistributionExpression& a)
+{
+    return DistributionExpression(makeNode(Node::Reciprocal, a.m_node,
+                                           shared_ptr<const Node>()));
+}
+
+DistributionExpression affine(const DistributionExpression& a,
+                              double scale, double shift)
+{
+    // scale*(s*x + t) + shift is fused into a single node
+    if(a.m_node->op == Node::Affine) {
+        const Node* inner = a.m_node.get();
+        return DistributionExpression(
+                    makeNode(Node::Affine, inner->lhs, shared_ptr<const Node>(),
+                             scale*inner->scale, scale*inner->shift + shift));
+    }
+
+    return DistributionExpression(makeNode(Node::Affine, a.m_node,
+                                           shared_ptr<const Node>(),
+                                           scale, shift));
+}
+
+DistributionExpression operator-(const DistributionExpression& a)
+{
+    return affine(a, -1.0, 0.0);
+}
+
+DistributionExpression operator+(const DistributionExpression& a, double b)
+{
+    return affine(a, 1.0, b);
+}
+
+DistributionExpression operator+(double a, const DistributionExpression& b)
+{
+    return affine(b, 1.0, a);
+}
+
+DistributionExpression operator-(const DistributionExpression& a, double b)
+{
+    return affine(a, 1.0, -b);
+}
+
+DistributionExpression operator-(double a, const DistributionExpression& b)
+{
+    return affine(b, -1.0, a);
+}
+
+DistributionExpression operator*(const DistributionExpression& a, double b)
+{
+    return affine(a, b, 0.0);
+}
+
+DistributionExpression operator*(double a, const DistributionExpression& b)
+{
+    return affine(b, a, 0.0);
+}
+
+DistributionExpression operator/(const DistributionExpression& a, double b)
+{
+    if(b == 0.0) {
+        return DistributionExpression((IDistribution*)0);
+    }
+    return affine(a, 1.0/b, 0.0);
+}
+
+DistributionExpression operator/(double a, const DistributionExpression& b)
+{
+    return affine(reciprocal(b), a, 0.0);
+}
+
+} // namespace CODeM
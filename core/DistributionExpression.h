@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef DISTRIBUTIONEXPRESSION_H
+#define DISTRIBUTIONEXPRESSION_H
+
+#include <memory>
+using namespace std;
+
+namespace CODeM {
+class IDistribution;
+
+// A lazily evaluated arithmetic expression of independent distributions,
+// e.g. DistributionExpression e = DistributionExpression(a)*b + 2.0;
+// The operations are only recorded; evaluate() runs them once. Chains of
+// add(double), multiply(double) and negate() are fused into one affine
+// z-remap, chains of sums into one convolution of all the terms, and no
+// cdf is built for the intermediate results.
+// The expression does not own the leaf distributions, which must outlive
+// the call to evaluate().
+class DistributionExpression
+{
+public:
+    // A null leaf makes an invalid expression
+    DistributionExpression(IDistribution* d);
+
+    // Returns a new distribution owned by the caller, or 0 when the
+    // expression is invalid. With nSamples > 1 the result is tabulated on
+    // that many equally spaced points; otherwise it keeps the grid of the
+    // last operation. The operations themselves sample their operands at
+    // Tigon::DistConvNSamples and Tigon::DistMultNSamples.
+    IDistribution* evaluate(int nSamples = 0) const;
+
+    friend DistributionExpression operator+(const DistributionExpression& a,
+                                            const DistributionExpression& b);
+    friend DistributionExpression operator-(const DistributionExpression& a,
+                                            const DistributionExpression& b);
+    friend DistributionExpression operator*(const DistributionExpression& a,
+                                            const DistributionExpression& b);
+    friend DistributionExpression operator/(const DistributionExpression& a,
+                                            const DistributionExpression& b);
+    friend DistributionExpression reciprocal(const DistributionExpression& a);
+    friend DistributionExpression affine(const DistributionExpression& a,
+                                         double scale, double shift);
+
+    struct Node;
+
+private:
+    explicit DistributionExpression(shared_ptr<const Node> node);
+
+    shared_ptr<const Node> m_node;
+};
+
+DistributionExpression operator+(const DistributionExpression& a,
+                                 const DistributionExpression& b);
+DistributionExpression operator-(const DistributionExpression& a,
+                                 const DistributionExpression& b);
+DistributionExpression operator*(const DistributionExpression& a,
+                                 const DistributionExpression& b);
+DistributionExpression operator/(const DistributionExpression& a,
+                                 const DistributionExpression& b);
+DistributionExpression reciprocal(const DistributionExpression& a);
+// scale*a + shift
+DistributionExpression affine(const DistributionExpression& a,
+                              double scale, double shift);
+
+DistributionExpression operator-(const DistributionExpression& a);
+DistributionExpression operator+(const DistributionExpression& a, double b);
+DistributionExpression operator+(double a, const DistributionExpression& b);
+DistributionExpression operator-(const DistributionExpression& a, double b);
+DistributionExpression operator-(double a, const DistributionExpression& b);
+DistributionExpression operator*(const DistributionExpression& a, double b);
+DistributionExpression operator*(double a, const DistributionExpression& b);
+// Division by 0.0 gives an invalid expression
+DistributionExpression operator/(const DistributionExpression& a, double b);
+DistributionExpression operator/(double a, const DistributionExpression& b);
+
+} // namespace CODeM
+
+#endif // DISTRIBUTIONEXPRESSION_H
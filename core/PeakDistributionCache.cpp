@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#include <core/PeakDistributionCache.h>
+#include <algorithm>
+#include <cmath>
+
+namespace CODeM {
+
+bool PeakDistributionCache::Key::operator<(const Key& other) const
+{
+    if(tendency != other.tendency) {
+        return tendency < other.tendency;
+    }
+    if(locality != other.locality) {
+        return locality < other.locality;
+    }
+    if(lb != other.lb) {
+        return lb < other.lb;
+    }
+    if(ub != other.ub) {
+        return ub < other.ub;
+    }
+    return nSamples < other.nSamples;
+}
+
+PeakDistributionCache::PeakDistributionCache()
+    : m_enabled(true),
+      m_tolerance(0.0),
+      m_capacity(32*1024*1024),
+      m_nBytes(0),
+      m_hits(0),
+      m_misses(0)
+{
+
+}
+
+PeakDistributionCache* PeakDistributionCache::instance()
+{
+    static PeakDistributionCache cache;
+    return &cache;
+}
+
+bool PeakDistributionCache::isEnabled() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_enabled;
+}
+
+void PeakDistributionCache::defineEnabled(bool e)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_enabled = e;
+}
+
+double PeakDistributionCache::tolerance() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_tolerance;
+}
+
+void PeakDistributionCache::defineTolerance(double tol)
+{
+    if(tol < 0.0) {
+        return;
+    }
+    lock_guard<mutex> lock(m_mutex);
+    if(tol != m_tolerance) {
+        // entries computed on the old grid would no longer be reachable
+        m_tolerance = tol;
+        m_entries.clear();
+        m_lru.clear();
+        m_nBytes = 0;
+    }
+}
+
+size_t PeakDistributionCache::capacity() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+void PeakDistributionCache::defineCapacity(size_t nBytes)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_capacity = nBytes;
+    evict();
+}
+
+void PeakDistributionCache::settings(bool& enabled, double& tolerance) const
+{
+    lock_guard<mutex> lock(m_mutex);
+    enabled   = m_enabled;
+    tolerance = m_tolerance;
+}
+
+double PeakDistributionCache::quantise(double val) const
+{
+    return quantise(val, tolerance());
+}
+
+double PeakDistributionCache::quantise(double val, double tolerance)
+{
+    if(tolerance <= 0.0) {
+        return val;
+    }
+    // the nearest grid point may lie outside the domain of the parameters
+    val = floor(val/tolerance + 0.5) * tolerance;
+    return std::min(std::max(val, 0.0), 1.0);
+}
+
+shared_ptr<const PeakDistributionTables> PeakDistributionCache::find(
+        double tendency, double locality, double lb, double ub, int nSamples)
+{
+    Key key = {tendency, locality, lb, ub, nSamples};
+
+    lock_guard<mutex> lock(m_mutex);
+    map<Key, Entry>::iterator it = m_entries.find(key);
+    if(it == m_entries.end()) {
+        m_misses++;
+        return shared_ptr<const PeakDistributionTables>();
+    }
+    m_hits++;
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+    return it->second.tables;
+}
+
+void PeakDistributionCache::insert(double tendency, double locality,
+                                   double lb, double ub,
+                                   shared_ptr<const PeakDistributionTables> tables)
+{
+    if(!tables) {
+        return;
+    }
+    Key key = {tendency, locality, lb, ub, (int)tables->z.size()};
+
+    lock_guard<mutex> lock(m_mutex);
+    map<Key, Entry>::iterator it = m_entries.find(key);
+    if(it != m_entries.end()) {
+        // another thread got there first; keep its tables
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+        return;
+    }
+    m_lru.push_front(key);
+    Entry entry = {tables, m_lru.begin(), tablesBytes(*tables)};
+    m_entries.insert(make_pair(key, entry));
+    m_nBytes += entry.nBytes;
+    evict();
+}
+
+void PeakDistributionCache::clear()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_entries.clear();
+    m_lru.clear();
+    m_nBytes = 0;
+    m_hits   = 0;
+    m_misses = 0;
+}
+
+long long PeakDistributionCache::hits() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_hits;
+}
+
+long long PeakDistributionCache::misses() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_misses;
+}
+
+int PeakDistributionCache::size() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+size_t PeakDistributionCache::memoryUsage() const
+{
+    lock_guard<mutex> lock(m_mutex);
+    return m_nBytes;
+}
+
+size_t PeakDistributionCache::tablesBytes(const PeakDistributionTables& tables)
+{
+    return sizeof(PeakDistributionTables)
+         + (tables.z.size() + tables.pdf.size() + tables.cdf.size())
+           * sizeof(double)
+         + tables.guideTable.size() * sizeof(int);
+}
+
+void PeakDistributionCache::evict()
+{
+    while(m_nBytes > m_capacity && !m_lru.empty()) {
+        map<Key, Entry>::iterator it = m_entries.find(m_lru.back());
+        m_nBytes -= it->second.nBytes;
+        m_entries.erase(it);
+        m_lru.pop_back();
+    }
+}
+
+} // namespace CODeM
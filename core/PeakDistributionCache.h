@@ -0,0 +1,114 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef PEAKDISTRIBUTIONCACHE_H
+#define PEAKDISTRIBUTIONCACHE_H
+
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+using namespace std;
+
+namespace CODeM {
+
+// Immutable z/pdf/cdf tables of a PeakDistribution, with the guide table
+// of the cdf so that instances sharing an entry also share the sampler
+struct PeakDistributionTables
+{
+    vector<double> z;
+    vector<double> pdf;
+    vector<double> cdf;
+    vector<int>    guideTable;
+};
+
+// Process-wide, thread-safe LRU cache of PeakDistribution tables, keyed by
+// the (tendency, locality) pair and the z grid. Tendency and locality are
+// quantised to tolerance(); with a zero tolerance only exact matches hit.
+// The least recently used entries are evicted while the tables take more
+// than capacity() bytes; an entry larger than the capacity is not kept.
+class PeakDistributionCache
+{
+public:
+    static PeakDistributionCache* instance();
+
+    bool   isEnabled()   const;
+    void   defineEnabled(bool e);
+    double tolerance()   const;
+    void   defineTolerance(double tol);
+    size_t capacity()    const;
+    void   defineCapacity(size_t nBytes);
+
+    // isEnabled() and tolerance() read under a single lock
+    void   settings(bool& enabled, double& tolerance) const;
+
+    // Snaps a tendency or locality value to the quantisation grid, within
+    // [0,1]
+    double quantise(double val) const;
+    static double quantise(double val, double tolerance);
+
+    shared_ptr<const PeakDistributionTables> find(double tendency,
+                                                  double locality,
+                                                  double lb, double ub,
+                                                  int nSamples);
+    void insert(double tendency, double locality, double lb, double ub,
+                shared_ptr<const PeakDistributionTables> tables);
+    void clear();
+
+    long long hits()     const;
+    long long misses()   const;
+    int       size()     const;
+    // bytes taken by the z, pdf, cdf and guide tables of the entries
+    size_t    memoryUsage() const;
+
+private:
+    PeakDistributionCache();
+
+    struct Key
+    {
+        double tendency;
+        double locality;
+        double lb;
+        double ub;
+        int    nSamples;
+        bool operator<(const Key& other) const;
+    };
+    typedef list<Key> KeyList;
+    struct Entry
+    {
+        shared_ptr<const PeakDistributionTables> tables;
+        KeyList::iterator                        lruPos;
+        size_t                                   nBytes;
+    };
+
+    static size_t tablesBytes(const PeakDistributionTables& tables);
+    void evict();
+
+    mutable mutex    m_mutex;
+    map<Key, Entry>  m_entries;
+    // most recently used key at the front
+    KeyList          m_lru;
+    bool             m_enabled;
+    double           m_tolerance;
+    size_t           m_capacity;
+    size_t           m_nBytes;
+    long long        m_hits;
+    long long        m_misses;
+};
+
+} // namespace CODeM
+
+#endif // PEAKDISTRIBUTIONCACHE_H
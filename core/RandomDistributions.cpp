@@ -15,10 +15,276 @@
 ****************************************************************************/
 #include <core/distributions/RandomDistributions.h>
 #include <random>
+#include <algorithm>
 #include <core/utils/LinearInterpolator.h>
+#include <core/utils/Convolution.h>
+#include <core/PeakDistributionCache.h>
+#include <core/utils/RandomStream.h>
 //#include <tigon/Utils/TigonUtils.h>
 
 namespace CODeM {
+
+namespace {
+
+bool isOneSigned(double lb, double ub)
+{
+    return (lb > 0.0) || (ub < 0.0);
+}
+
+// The pieces of a split support span up to ln(DistConvNSamples) in the log
+// domain, several times a typical one-signed support, so they are sampled
+// more finely to keep a comparable resolution
+const int MixedSignLogSamplesFactor = 4;
+
+// Below this many output samples the quadratic grid method is about as
+// fast as the strip integration of supports containing zero
+// (tests/ProductBenchmark), and more accurate for densities with jumps
+const int StripMinNSamples = 500;
+
+// A step between neighbouring probes, or a value at an end of the support,
+// above this fraction of the peak density is taken as a jump
+const double JumpFraction = 0.5;
+
+// Whether the density of d jumps inside or at the ends of [lb,ub], as a
+// uniform does at its bounds, probed at nProbe+1 equally spaced points.
+// The log grid of the strip integration resolves a jump only at first
+// order, so such densities keep the grid method.
+bool hasJump(const IDistribution* d, double lb, double ub, int nProbe)
+{
+    double dz = (ub-lb) / nProbe;
+    vector<double> p(nProbe+1);
+    double peak = 0.0;
+    for(int i=0; i<=nProbe; i++) {
+        p[i] = d->pdf((i == nProbe) ? ub : lb + i*dz);
+        peak = qMax(peak, p[i]);
+    }
+    if(!(peak > 0.0)) {
+        return false;
+    }
+    double limit = JumpFraction*peak;
+    if(p[0] > limit || p[nProbe] > limit) {
+        return true;
+    }
+    for(int i=0; i<nProbe; i++) {
+        if(qAbs(p[i+1]-p[i]) > limit) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The pdf of d on equally spaced points from its lower to its upper bound,
+// as many as a spacing of about dz gives
+vector<double> pdfOnGrid(const IDistribution* d, double dz)
+{
+    double lb = d->lowerBound();
+    double ub = d->upperBound();
+    int nSamples = (int)((ub-lb)/dz) + 1;
+    double dzD = (ub-lb) / (nSamples-1);
+
+    vector<double> p(nSamples);
+    double zz = lb;
+    for(int i=0; i<nSamples-1; i++) {
+        p[i] = d->pdf(zz);
+        zz += dzD;
+    }
+    p[nSamples-1] = d->pdf(ub);
+    return p;
+}
+
+// The part of a distribution with values s*x, x in [a,b], 0 < a < b
+struct SignedPiece
+{
+    const IDistribution* d;
+    double s;
+    double a;
+    double b;
+};
+
+// The part of a distribution in [lb,ub], lb <= 0 <= ub, taken as uniform
+// with the given mass
+struct ZeroStrip
+{
+    double lb;
+    double ub;
+    double mass;
+};
+
+// Splits the support [lb,ub] of d into the one-signed pieces appended to
+// pieces, and the strip around zero that is returned. The strip is
+// 1/DistConvNSamples of the largest bound wide on either side, which keeps
+// the dynamic range of the pieces in the log domain to that ratio. A
+// one-signed support is a single piece and has an empty strip.
+ZeroStrip splitAtZero(const IDistribution* d, double lb, double ub,
+                      vector<SignedPiece>& pieces)
+{
+    ZeroStrip strip = {0.0, 0.0, 0.0};
+    if(isOneSigned(lb, ub)) {
+        SignedPiece p = {d, (lb > 0.0) ? 1.0 : -1.0,
+                         qMin(qAbs(lb), qAbs(ub)), qMax(qAbs(lb), qAbs(ub))};
+        pieces.push_back(p);
+        return strip;
+    }
+
+    double delta = qMax(qAbs(lb), qAbs(ub)) / Tigon::DistConvNSamples;
+    strip.lb = qMax(lb, -delta);
+    strip.ub = qMin(ub,  delta);
+    if(ub > delta) {
+        SignedPiece p = {d,  1.0, delta, ub};
+        pieces.push_back(p);
+    }
+    if(lb < -delta) {
+        SignedPiece p = {d, -1.0, delta, -lb};
+        pieces.push_back(p);
+    }
+
+    // trapezoidal mass of the strip
+    double p0 = d->pdf(0.0);
+    strip.mass = (d->pdf(strip.lb) + p0)/2 * (-strip.lb)
+               + (p0 + d->pdf(strip.ub))/2 * strip.ub;
+    return strip;
+}
+
+// Adds the density of X*Y, or X/Y, on the grid z to f, for the one-signed
+// pieces X = t and Y = o. The densities of log|X| and log|Y| are
+// convolved, which is O(n*log(n)). Points of z outside the range of the
+// result are clamped to its ends with clampToRange, and skipped otherwise.
+void addLogDomainProduct(const SignedPiece& t, const SignedPiece& o,
+                         bool divide, const vector<double>& z,
+                         vector<double>& f, bool clampToRange,
+                         int nLogSamples)
+{
+    // common resolution in the log domain
+    double logAT = log(t.a);
+    double logAO = log(o.a);
+    double du = qMax(log(t.b)-logAT, log(o.b)-logAO) / nLogSamples;
+    int nT = (int)ceil((log(t.b)-logAT)/du) + 1;
+    int nO = (int)ceil((log(o.b)-logAO)/du) + 1;
+
+    // densities of log|X| and log|Y|: f(e^u)*e^u
+    vector<double> gT(nT);
+    for(int i=0; i<nT; i++) {
+        double x = exp(logAT + i*du);
+        gT[i] = t.d->pdf(t.s*x) * x;
+    }
+    vector<double> gO(nO);
+    for(int j=0; j<nO; j++) {
+        double y = exp(logAO + j*du);
+        gO[j] = o.d->pdf(o.s*y) * y;
+    }
+
+    // log|X/Y| = log|X| + (-log|Y|), and -log|Y| has the reversed density
+    double w0;
+    if(divide) {
+        std::reverse(gO.begin(), gO.end());
+        w0 = logAT - (logAO + (nO-1)*du);
+    } else {
+        w0 = logAT + logAO;
+    }
+    vector<double> h = convolve(gT, gO);
+    int nH = h.size();
+    double s = t.s * o.s;
+
+    // transform back: f_Z(z) = h(log|z|)/|z|, with the du of the
+    // convolution sum so that pieces with different du add up
+    int nSamples = z.size();
+    for(int i=0; i<nSamples; i++) {
+        double absZ = qAbs(z[i]);
+        double pos = (log(absZ) - w0) / du;
+        if(!clampToRange && (z[i]*s <= 0.0 || pos < 0.0 || pos > nH-1)) {
+            continue;
+        }
+        pos = qMax(0.0, qMin(pos, (double)(nH-1)));
+        int k = qMin((int)pos, nH-2);
+        double hz = h[k] + (pos-k)*(h[k+1]-h[k]);
+        f[i] += qMax(hz, 0.0) * du / absZ;
+    }
+}
+
+// Adds the density of U*Y, or U/Y, on the grid z to f, for U uniform on
+// the strip and the one-signed piece Y. With |Y| = v the product has the
+// density mass/width * integral of f_Y(v)/v over v >= |z|/e, and the
+// quotient mass/width * integral of f_Y(v)*v over v <= e/|z|, where e is
+// the strip bound on the side of z/sign(Y). Both are read off cumulative
+// trapezoidal sums over the piece.
+void addStripProduct(const ZeroStrip& strip, const SignedPiece& o,
+                     bool divide, const vector<double>& z, vector<double>& f)
+{
+    int nV = Tigon::DistConvNSamples + 1;
+    double dv = (o.b - o.a) / (nV-1);
+
+    // cum[k] is the integral over [a, v_k] of f_Y(v)*v (quotient), or over
+    // [v_k, b] of f_Y(v)/v (product)
+    vector<double> g(nV);
+    for(int k=0; k<nV; k++) {
+        double v = (k == nV-1) ? o.b : o.a + k*dv;
+        double p = o.d->pdf(o.s*v);
+        g[k] = divide ? p*v : p/v;
+    }
+    vector<double> cum(nV, 0.0);
+    if(divide) {
+        for(int k=1; k<nV; k++) {
+            cum[k] = cum[k-1] + (g[k-1]+g[k])/2 * dv;
+        }
+    } else {
+        for(int k=nV-2; k>=0; k--) {
+            cum[k] = cum[k+1] + (g[k]+g[k+1])/2 * dv;
+        }
+    }
+
+    double scale = strip.mass / (strip.ub - strip.lb);
+    int nSamples = z.size();
+    for(int i=0; i<nSamples; i++) {
+        double absZ = qAbs(z[i]);
+        double e = (z[i]*o.s >= 0.0) ? strip.ub : -strip.lb;
+        double v;
+        if(absZ == 0.0) {
+            v = divide ? o.b : o.a;
+        } else if(e <= 0.0) {
+            continue;
+        } else {
+            v = divide ? e/absZ : absZ/e;
+        }
+        v = qMax(o.a, qMin(v, o.b));
+
+        double pos = (v - o.a) / dv;
+        int k = qMin((int)pos, nV-2);
+        f[i] += scale * (cum[k] + (pos-k)*(cum[k+1]-cum[k]));
+    }
+}
+
+// ln(p*q/absZ) where positive, 0 otherwise
+double logTerm(double p, double q, double absZ)
+{
+    double pq = p*q;
+    return (pq > absZ) ? log(pq/absZ) : 0.0;
+}
+
+// Adds the density of U1*U2 on the grid z to f, for U1 and U2 uniform on
+// the two strips: per pair of strip bounds p, q on the matching sides it is
+// ln(p*q/|z|)/(width1*width2) for |z| < p*q. |z| is kept above minAbsZ, and
+// z = 0 takes the mean of the two sides.
+void addStripStripProduct(const ZeroStrip& s1, const ZeroStrip& s2,
+                          const vector<double>& z, double minAbsZ,
+                          vector<double>& f)
+{
+    double scale = s1.mass * s2.mass
+                 / ((s1.ub - s1.lb) * (s2.ub - s2.lb));
+    int nSamples = z.size();
+    for(int i=0; i<nSamples; i++) {
+        double absZ = qMax(qAbs(z[i]), minAbsZ);
+        // same-signed factors give z > 0, opposite-signed ones z < 0
+        double pos = logTerm(s1.ub,  s2.ub,  absZ)
+                   + logTerm(-s1.lb, -s2.lb, absZ);
+        double neg = logTerm(s1.ub,  -s2.lb, absZ)
+                   + logTerm(-s1.lb, s2.ub,  absZ);
+        double val = (z[i] > 0.0) ? pos : (z[i] < 0.0) ? neg : (pos+neg)/2;
+        f[i] += scale * val;
+    }
+}
+
+} // namespace
+
 IDistribution::IDistribution()
 {
     m_type = Tigon::GenericDistType;
@@ -29,6 +295,9 @@ IDistribution::IDistribution()
     m_pdfInterpolator      = 0;
     m_cdfInterpolator      = 0;
     m_quantileInterpolator = 0;
+    m_samplingMethod       = InterpolatorSampling;
+    m_isCDFDeferred        = false;
+    invalidateTables();
 }
 
 IDistribution::IDistribution(const IDistribution& dist)
@@ -44,6 +313,9 @@ IDistribution::IDistribution(const IDistribution& dist)
     m_pdfInterpolator      = 0;
     m_cdfInterpolator      = 0;
     m_quantileInterpolator = 0;
+    m_samplingMethod       = dist.m_samplingMethod;
+    m_isCDFDeferred        = dist.m_isCDFDeferred;
+    invalidateTables();
 }
 
 IDistribution::IDistribution(double value)
@@ -56,6 +328,9 @@ IDistribution::IDistribution(double value)
     m_pdfInterpolator      = 0;
     m_cdfInterpolator      = 0;
     m_quantileInterpolator = 0;
+    m_samplingMethod       = InterpolatorSampling;
+    m_isCDFDeferred        = false;
+    invalidateTables();
 
     defineBoundaries(value,value);
 }
@@ -88,14 +363,46 @@ vector<double> IDistribution::parameters()
     return vector<double>();
 }
 
-double IDistribution::sample()
+void IDistribution::prepareForSampling()
 {
+    if(m_isQuantileUpToDate) {
+        return;
+    }
+
+    // cdf() and zSamples() may regenerate the state, so query them first
+    vector<double> c = cdf();
+    vector<double> z = zSamples();
     if(m_quantileInterpolator == 0) {
-        m_quantileInterpolator = new LinearInterpolator(cdf(), zSamples());
+        m_quantileInterpolator = new LinearInterpolator(c, z);
     } else {
-        m_quantileInterpolator->defineXY(cdf(), zSamples());
+        m_quantileInterpolator->defineXY(c, z);
+    }
+    if(m_samplingMethod == GuideTableSampling) {
+        buildGuideTable(m_cdf, m_guideTable);
+    }
+    m_isQuantileUpToDate = true;
+}
+
+void IDistribution::defineSamplingMethod(SamplingMethod method)
+{
+    if(method != m_samplingMethod) {
+        m_samplingMethod = method;
+        m_isQuantileUpToDate = false;
+    }
+}
+
+SamplingMethod IDistribution::samplingMethod() const
+{
+    return m_samplingMethod;
+}
+
+double IDistribution::sample()
+{
+    prepareForSampling();
+    double r = currentRandomStream()->randUni();
+    if(m_samplingMethod == GuideTableSampling) {
+        return guideTableSample(r, m_z, m_cdf, m_guideTable);
     }
-    double r = TRAND.randUni();
     // A value between 0-1: 0==>lb , 1==>ub
     double sample = m_quantileInterpolator->interpolate(r);
     return sample;
@@ -117,11 +424,7 @@ double IDistribution::mean()
 
 double IDistribution::median()
 {
-    if(m_quantileInterpolator == 0) {
-        m_quantileInterpolator = new LinearInterpolator(cdf(),zSamples());
-    } else {
-        m_quantileInterpolator->defineXY(cdf(),zSamples());
-    }
+    prepareForSampling();
     return m_quantileInterpolator->interpolate(0.5);
 }
 
@@ -137,11 +440,7 @@ double IDistribution::percentile(double p)
         return m_lb;
     }
 
-    if(m_quantileInterpolator == 0) {
-        m_quantileInterpolator = new LinearInterpolator(cdf(),zSamples());
-    } else {
-        m_quantileInterpolator->defineXY(cdf(),zSamples());
-    }
+    prepareForSampling();
     return m_quantileInterpolator->interpolate(p);
 }
 
@@ -206,10 +505,15 @@ double IDistribution::pdf(double z)
         return 0.0;
     }
 
-    if(m_pdfInterpolator == 0) {
-        m_pdfInterpolator = new LinearInterpolator(zSamples(), pdf());
-    } else {
-        m_pdfInterpolator->defineXY(zSamples(), pdf());
+    if(!m_isPdfUpToDate) {
+        vector<double> zVec = zSamples();
+        vector<double> p = pdf();
+        if(m_pdfInterpolator == 0) {
+            m_pdfInterpolator = new LinearInterpolator(zVec, p);
+        } else {
+            m_pdfInterpolator->defineXY(zVec, p);
+        }
+        m_isPdfUpToDate = true;
     }
 
 
@@ -227,10 +531,15 @@ double IDistribution::cdf(double z)
     } else if(z >= m_ub) {
         return 1.0;
     } else {
-        if(m_cdfInterpolator == 0) {
-            m_cdfInterpolator = new LinearInterpolator(zSamples(), cdf());
-        } else {
-            m_cdfInterpolator->defineXY(zSamples(), cdf());
+        if(!m_isCdfUpToDate) {
+            vector<double> zVec = zSamples();
+            vector<double> c = cdf();
+            if(m_cdfInterpolator == 0) {
+                m_cdfInterpolator = new LinearInterpolator(zVec, c);
+            } else {
+                m_cdfInterpolator->defineXY(zVec, c);
+            }
+            m_isCdfUpToDate = true;
         }
         return m_cdfInterpolator->interpolate(z);
     }
@@ -262,6 +571,7 @@ void IDistribution::defineBoundaries(double lb, double ub)
     }
 
     // TODO: test scaling
+    invalidateTables();
 
     double oldRange = m_ub - m_lb;
     double newRange = ub - lb;
@@ -295,6 +605,7 @@ double IDistribution::upperBound() const
 
 void IDistribution::defineZ(vector<double> z)
 {
+    invalidateTables();
     std::sort(z.begin(),z.end());
     QMutableVectorIterator<double> i(z);
     if(i.hasNext()) {
@@ -338,6 +649,7 @@ void IDistribution::generateZ()
 
 void IDistribution::generatePDF()
 {
+    invalidateTables();
     // uniform distribution
     double probability = 1.0/(m_ub - m_lb);
     m_pdf.fill(probability, m_nSamples);
@@ -345,6 +657,7 @@ void IDistribution::generatePDF()
 
 void IDistribution::generateEquallySpacedZ()
 {
+    invalidateTables();
     m_nSamples = (int)((m_ub-m_lb)/m_dz) + 1;
     m_z.resize(m_nSamples);
     double zz=m_lb;
@@ -357,6 +670,7 @@ void IDistribution::generateEquallySpacedZ()
 
 void IDistribution::calculateCDF()
 {
+    invalidateTables();
     if(m_pdf.isEmpty()) {
         generatePDF();
     }
@@ -385,6 +699,112 @@ void IDistribution::calculateCDF()
     }
 }
 
+void IDistribution::invalidateTables()
+{
+    m_isQuantileUpToDate = false;
+    m_isPdfUpToDate      = false;
+    m_isCdfUpToDate      = false;
+}
+
+void IDistribution::buildGuideTable(const vector<double>& cdf,
+                                    vector<int>& guideTable)
+{
+    // guideTable[g] is the first interval j with cdf[j+1] > g/nGuide,
+    // so a search that starts there never has to step backwards
+    int nSamples = cdf.size();
+    int nGuide = nSamples;
+    guideTable.resize(nGuide);
+    int j = 0;
+    for(int g=0; g<nGuide; g++) {
+        double r = (double)g / nGuide;
+        while(j < nSamples-2 && cdf[j+1] <= r) {
+            j++;
+        }
+        guideTable[g] = j;
+    }
+}
+
+double IDistribution::guideTableSample(double r, const vector<double>& z,
+                                       const vector<double>& cdf,
+                                       const vector<int>& guideTable)
+{
+    // a degenerate grid has no interval to invert
+    int nSamples = cdf.size();
+    if(nSamples < 2 || guideTable.isEmpty()) {
+        return z[0];
+    }
+    int nGuide = guideTable.size();
+    int g = qMin((int)(r*nGuide), nGuide-1);
+    int j = guideTable[g];
+    while(j < nSamples-2 && cdf[j+1] <= r) {
+        j++;
+    }
+
+    // same piecewise-linear inversion as the quantile interpolator
+    if(cdf[j] == cdf[j+1]) {
+        return z[j];
+    }
+    return z[j] + ((r-cdf[j])/(cdf[j+1]-cdf[j]))*(z[j+1]-z[j]);
+}
+
+void IDistribution::defineDeferredCDF(bool deferred)
+{
+    m_isCDFDeferred = deferred;
+    if(!deferred && m_cdf.isEmpty() && !m_pdf.isEmpty()) {
+        calculateCDF();
+    }
+}
+
+bool IDistribution::isCDFDeferred() const
+{
+    return m_isCDFDeferred;
+}
+
+void IDistribution::resample(int nSamples)
+{
+    if(nSamples < 2 || m_z.size() < 2 || m_z.size() != m_pdf.size()) {
+        return;
+    }
+    invalidateTables();
+
+    // linear interpolation of the old table, walked once
+    vector<double> z(nSamples);
+    vector<double> p(nSamples);
+    double dz = (m_ub-m_lb)/(nSamples-1);
+    int j = 0;
+    for(int i=0; i<nSamples; i++) {
+        z[i] = (i == nSamples-1) ? m_ub : m_lb + i*dz;
+        while(j < m_nSamples-2 && m_z[j+1] < z[i]) {
+            j++;
+        }
+        double w = 0.0;
+        if(m_z[j+1] > m_z[j]) {
+            w = qMin(qMax((z[i]-m_z[j]) / (m_z[j+1]-m_z[j]), 0.0), 1.0);
+        }
+        p[i] = m_pdf[j] + w*(m_pdf[j+1]-m_pdf[j]);
+    }
+
+    m_z.swap(z);
+    m_pdf.swap(p);
+    m_dz = dz;
+    m_nSamples = nSamples;
+    updateCDF();
+}
+
+void IDistribution::updateCDF()
+{
+    if(m_pdf.isEmpty()) {
+        return;
+    }
+    if(m_isCDFDeferred) {
+        // left unnormalised; cdf() rebuilds it on demand
+        invalidateTables();
+        m_cdf.clear();
+        return;
+    }
+    calculateCDF();
+}
+
 void IDistribution::normalise()
 {
     if(m_pdf.isEmpty()) {
@@ -396,6 +816,7 @@ void IDistribution::normalise()
 
 void IDistribution::negate()
 {
+    invalidateTables();
     double ub = m_ub;
     m_ub = -m_lb;
     m_lb = -ub;
@@ -417,11 +838,12 @@ void IDistribution::negate()
         newPdf[i] = m_pdf[m_nSamples-1-i];
     }
     m_pdf.swap(newPdf);
-    calculateCDF();
+    updateCDF();
 }
 
 void IDistribution::add(double num)
 {
+    invalidateTables();
     m_ub += num;
     m_lb += num;
 
@@ -433,26 +855,47 @@ void IDistribution::add(double num)
     }
 
     if(!m_pdf.isEmpty()) {
-        calculateCDF();
+        updateCDF();
     }
 }
 
 void IDistribution::add(const IDistribution* other)
 {
-    double lbO = other->lowerBound();
-    double ubO = other->upperBound();
-    double lb = m_lb + lbO;
-    double ub = m_ub + ubO;
-    double dz = qMax(m_ub-m_lb, ubO-lbO)/Tigon::DistConvNSamples;
+    convolveWith(vector<const IDistribution*>(1, other));
+}
+
+void IDistribution::add(const vector<const IDistribution*>& others)
+{
+    if(others.empty()) {
+        return;
+    }
+    convolveWith(others);
+}
+
+void IDistribution::convolveWith(const vector<const IDistribution*>& others)
+{
+    invalidateTables();
+    double lb = m_lb;
+    double ub = m_ub;
+    double width = m_ub - m_lb;
+    for(int k=0; k<others.size(); k++) {
+        lb += others[k]->lowerBound();
+        ub += others[k]->upperBound();
+        width = qMax(width, others[k]->upperBound() - others[k]->lowerBound());
+    }
+    double dz = width/Tigon::DistConvNSamples;
 
-    int nSampT = (int)((m_ub-m_lb)/dz) + 1;
-    int nSampO = (int)((ubO-lbO)/dz) + 1;
-    int nSamples = nSampT + nSampO - 1;
+    // the original distributions on evenly spaced samples
+    vector<vector<double> > pdfs(others.size()+1);
+    pdfs[0] = pdfOnGrid(this, dz);
+    int nSamples = pdfs[0].size();
+    for(int k=0; k<others.size(); k++) {
+        pdfs[k+1] = pdfOnGrid(others[k], dz);
+        nSamples += pdfs[k+1].size() - 1;
+    }
 
-    // corrections to dz
+    // correction to dz
     dz = (ub-lb)/(nSamples-1);
-    double dzT = (m_ub-m_lb) / (nSampT-1);
-    double dzO = (ubO - lbO) / (nSampO-1);
 
     // evenly distributed samples for convoluted distribution
     vector<double> z(nSamples);
@@ -463,25 +906,14 @@ void IDistribution::add(const IDistribution* other)
     }
     z[nSamples-1] = ub;
 
-    // and for original distributions
-    vector<double> pdfT(nSampT);
-    zz = m_lb;
-    for(int i=0; i<nSampT-1; i++) {
-        pdfT[i] = pdf(zz);
-        zz += dzT;
-    }
-    pdfT[nSampT-1] = pdf(m_ub);
-
-    vector<double> pdfO(nSampO);
-    zz = lbO;
-    for(int i=0; i<nSampO-1; i++) {
-        pdfO[i] = other->pdf(zz);
-        zz += dzO;
+    // convolute the pdfs
+    m_pdf = convolve(pdfs);
+    // the FFT path can leave round-off negatives
+    for(int i=0; i<m_pdf.size(); i++) {
+        if(m_pdf[i] < 0.0) {
+            m_pdf[i] = 0.0;
+        }
     }
-    pdfO[nSampO-1] = other->pdf(ubO);
-
-    // convolute the two pdfs
-    m_pdf = conv(pdfT,pdfO);
 
     // update the distribution
     m_z.swap(z);
@@ -490,7 +922,44 @@ void IDistribution::add(const IDistribution* other)
     m_dz = dz;
     m_nSamples = nSamples;
 
-    normalise();
+    updateCDF();
+}
+
+void IDistribution::affineTransform(double scale, double shift)
+{
+    if(scale == 0.0) {
+        multiply(0.0);
+        add(shift);
+        return;
+    }
+    invalidateTables();
+
+    double lb = scale*m_lb + shift;
+    double ub = scale*m_ub + shift;
+    m_lb = qMin(lb, ub);
+    m_ub = qMax(lb, ub);
+    m_dz *= qAbs(scale);
+
+    if(m_z.isEmpty()) {
+        return;
+    }
+    if(scale > 0.0) {
+        for(int i=0; i<m_nSamples; i++) {
+            m_z[i] = scale*m_z[i] + shift;
+        }
+    } else {
+        vector<double> newZ(m_nSamples);
+        for(int i=0; i<m_nSamples; i++) {
+            newZ[i] = scale*m_z[m_nSamples-1-i] + shift;
+        }
+        m_z.swap(newZ);
+
+        if(!m_pdf.isEmpty()) {
+            std::reverse(m_pdf.begin(), m_pdf.end());
+        }
+    }
+
+    updateCDF();
 }
 
 void IDistribution::subtract(double num)
@@ -507,6 +976,7 @@ void IDistribution::subtract(const IDistribution* other)
 
 void IDistribution::multiply(double num)
 {
+    invalidateTables();
     if(num == 0)
     {
         m_lb = 0.0;
@@ -515,7 +985,7 @@ void IDistribution::multiply(double num)
         m_z.clear();
         m_z << m_lb << (m_lb+m_ub)/2 << m_ub;
         m_pdf.fill(1.0,2);
-        normalise();
+        updateCDF();
         return;
     }
 
@@ -535,74 +1005,27 @@ void IDistribution::multiply(double num)
     }
 
     if(!m_pdf.isEmpty()) {
-        calculateCDF();
+        updateCDF();
     }
 }
 
 void IDistribution::multiply(const IDistribution* other)
 {
+    invalidateTables();
     double lbO = other->lowerBound();
     double ubO = other->upperBound();
-    double lb  = qMin(m_lb*lbO,qMin(m_lb*ubO,qMin(m_ub*lbO,m_ub*ubO)));
-    double ub  = qMax(m_lb*lbO,qMax(m_lb*ubO,qMax(m_ub*lbO,m_ub*ubO)));
-
-    int nSamples = Tigon::DistMultNSamples;
-    double dz  = (ub-lb) / (nSamples-1);
-    double dzT = (m_ub-m_lb) / (nSamples-1);
-
-    // evenly distributed samples for joint multiplied distribution
-    vector<double> z(nSamples);
-    double zz = lb;
-    for(int i=0; i<nSamples-1; i++) {
-        z[i] = zz;
-        zz += dz;
-    }
-    z[nSamples-1] = ub;
-
-    // and for original distributions
-    vector<double> zT(nSamples);
-    zz = m_lb;
-    for(int i=0; i<nSamples-1; i++) {
-        zT[i] = zz;
-        zz += dzT;
+    if(isOneSigned(m_lb, m_ub) && isOneSigned(lbO, ubO)) {
+        logDomainMultiply(other, false, Tigon::DistMultNSamples,
+                          Tigon::DistConvNSamples);
+        return;
     }
-    zT[nSamples-1] = m_ub;
 
-    // multiply the two distributions
-    vector<double> newPDF(nSamples);
-    for(int i=0; i<nSamples; i++) {
-        for(int j=0; j<nSamples; j++) {
-            double zt = zT[j];
-            if(qAbs(zt) >= dzT/2) {
-                double zo = z[i]/zt;
-                if(zo >= lbO && zo <= ubO) {
-                    newPDF[i] += pdf(zt) * other->pdf(zo) / qAbs(zt);
-                }
-            } else {
-                zt = -dzT/2;
-                double zo = z[i]/zt;
-                if(zo >= lbO && zo <= ubO) {
-                    newPDF[i] += pdf(zt) * other->pdf(zo) / qAbs(zt) / 2.0;
-                }
-                zt = dzT/2;
-                zo = z[i]/zt;
-                if(zo >= lbO && zo <= ubO) {
-                    newPDF[i] += pdf(zt) * other->pdf(zo) / qAbs(zt) / 2.0;
-                }
-            }
-        }
-        newPDF[i] *= dzT;
+    if(useStripIntegration(other, Tigon::DistMultNSamples)) {
+        mixedSignMultiply(other, false, Tigon::DistMultNSamples,
+                          Tigon::DistConvNSamples);
+    } else {
+        gridMultiply(other, false, Tigon::DistMultNSamples);
     }
-
-    // update the distribution
-    m_pdf.swap(newPDF);
-    m_z.swap(z);
-    m_ub = ub;
-    m_lb = lb;
-    m_dz = dz;
-    m_nSamples = nSamples;
-
-    normalise();
 }
 
 void IDistribution::divide(double num)
@@ -617,6 +1040,7 @@ void IDistribution::divide(double num)
 
 void IDistribution::divide(const IDistribution* other)
 {
+    invalidateTables();
     double lbO = other->lowerBound();
     double ubO = other->upperBound();
     double lb,ub;
@@ -650,43 +1074,109 @@ void IDistribution::divide(const IDistribution* other)
         return;
     }
 
-    lb  = qMin(m_lb/lbO,qMin(m_lb/ubO,qMin(m_ub/lbO,m_ub/ubO)));
-    ub  = qMax(m_lb/lbO,qMax(m_lb/ubO,qMax(m_ub/lbO,m_ub/ubO)));
-
+    if(isOneSigned(m_lb, m_ub)) {
+        logDomainMultiply(other, true, Tigon::DistMultNSamples,
+                          Tigon::DistConvNSamples);
+        return;
+    }
 
-    int nSamples = Tigon::DistMultNSamples;
-    double dz  = (ub-lb) / (nSamples-1);
-    double dzO = (ubO-lbO) / (nSamples-1);
+    if(useStripIntegration(other, Tigon::DistMultNSamples)) {
+        mixedSignMultiply(other, true, Tigon::DistMultNSamples,
+                          Tigon::DistConvNSamples);
+    } else {
+        gridMultiply(other, true, Tigon::DistMultNSamples);
+    }
+}
 
-    // evenly distributed samples for joint divided distribution
+void IDistribution::logDomainMultiply(const IDistribution* other, bool divide,
+                                      int nSamples, int nLogSamples)
+{
+    double lbO = other->lowerBound();
+    double ubO = other->upperBound();
+    SignedPiece t = {this,  (m_lb > 0.0) ? 1.0 : -1.0,
+                     qMin(qAbs(m_lb), qAbs(m_ub)), qMax(qAbs(m_lb), qAbs(m_ub))};
+    SignedPiece o = {other, (lbO  > 0.0) ? 1.0 : -1.0,
+                     qMin(qAbs(lbO), qAbs(ubO)),   qMax(qAbs(lbO), qAbs(ubO))};
+
+    double s = t.s * o.s;
+    double absLb = divide ? t.a/o.b : t.a*o.a;
+    double absUb = divide ? t.b/o.a : t.b*o.b;
+    double lb = (s > 0.0) ? absLb  : -absUb;
+    double ub = (s > 0.0) ? absUb  : -absLb;
+
+    double dz = (ub-lb) / (nSamples-1);
     vector<double> z(nSamples);
     double zz = lb;
-    for(int i=0; i<nSamples-1; i++) {
-        z[i] = zz;
+    for(int i=0; i<nSamples; i++) {
+        z[i] = (i == nSamples-1) ? ub : zz;
         zz += dz;
     }
-    z[nSamples-1] = ub;
 
-    // and for original distribution
-    vector<double> zO(nSamples);
-    zz = lbO;
-    for(int i=0; i<nSamples-1; i++) {
-        zO[i] = zz;
-        zz += dzO;
+    vector<double> newPDF(nSamples, 0.0);
+    addLogDomainProduct(t, o, divide, z, newPDF, true, nLogSamples);
+
+    // update the distribution
+    m_pdf.swap(newPDF);
+    m_z.swap(z);
+    m_ub = ub;
+    m_lb = lb;
+    m_dz = dz;
+    m_nSamples = nSamples;
+
+    updateCDF();
+}
+
+void IDistribution::mixedSignMultiply(const IDistribution* other, bool divide,
+                                      int nSamples, int nLogSamples)
+{
+    double lbO = other->lowerBound();
+    double ubO = other->upperBound();
+
+    double lb, ub;
+    if(divide) {
+        lb = qMin(m_lb/lbO,qMin(m_lb/ubO,qMin(m_ub/lbO,m_ub/ubO)));
+        ub = qMax(m_lb/lbO,qMax(m_lb/ubO,qMax(m_ub/lbO,m_ub/ubO)));
+    } else {
+        lb = qMin(m_lb*lbO,qMin(m_lb*ubO,qMin(m_ub*lbO,m_ub*ubO)));
+        ub = qMax(m_lb*lbO,qMax(m_lb*ubO,qMax(m_ub*lbO,m_ub*ubO)));
     }
-    zO[nSamples-1] = ubO;
 
-    // divide the two distributions
-    vector<double> newPDF(nSamples);
+    double dz = (ub-lb) / (nSamples-1);
+    vector<double> z(nSamples);
+    double zz = lb;
     for(int i=0; i<nSamples; i++) {
-        for(int j=0; j<nSamples; j++) {
-            double zo = zO[j];
-                double zt = z[i]*zo;
-                if(zt >= m_lb && zt <= m_ub) {
-                    newPDF[i] += other->pdf(zo) * pdf(zt) * qAbs(zo);
-                }
+        z[i] = (i == nSamples-1) ? ub : zz;
+        zz += dz;
+    }
+
+    // one-signed pieces and the strips around zero of both operands
+    vector<SignedPiece> piecesT;
+    vector<SignedPiece> piecesO;
+    ZeroStrip stripT = splitAtZero(this,  m_lb, m_ub, piecesT);
+    ZeroStrip stripO = splitAtZero(other, lbO,  ubO,  piecesO);
+
+    int nPiecesT = piecesT.size();
+    int nPiecesO = piecesO.size();
+    vector<double> newPDF(nSamples, 0.0);
+    for(int i=0; i<nPiecesT; i++) {
+        for(int j=0; j<nPiecesO; j++) {
+            addLogDomainProduct(piecesT[i], piecesO[j], divide, z, newPDF,
+                                false, MixedSignLogSamplesFactor*nLogSamples);
+        }
+    }
+    // the divisor is one-signed, so only the dividend can have a strip
+    if(stripT.mass > 0.0) {
+        for(int j=0; j<nPiecesO; j++) {
+            addStripProduct(stripT, piecesO[j], divide, z, newPDF);
+        }
+    }
+    if(!divide && stripO.mass > 0.0) {
+        for(int i=0; i<nPiecesT; i++) {
+            addStripProduct(stripO, piecesT[i], false, z, newPDF);
+        }
+        if(stripT.mass > 0.0) {
+            addStripStripProduct(stripT, stripO, z, 0.5*dz, newPDF);
         }
-        newPDF[i] *= dzO;
     }
 
     // update the distribution
@@ -697,11 +1187,105 @@ void IDistribution::divide(const IDistribution* other)
     m_dz = dz;
     m_nSamples = nSamples;
 
-    normalise();
+    updateCDF();
+}
+
+bool IDistribution::useStripIntegration(const IDistribution* other,
+                                        int nSamples)
+{
+    if(nSamples < StripMinNSamples) {
+        return false;
+    }
+    return !hasJump(this,  m_lb, m_ub, Tigon::DistConvNSamples) &&
+           !hasJump(other, other->lowerBound(), other->upperBound(),
+                    Tigon::DistConvNSamples);
+}
+
+void IDistribution::gridMultiply(const IDistribution* other, bool divide,
+                                 int nSamples)
+{
+    double lbO = other->lowerBound();
+    double ubO = other->upperBound();
+
+    double lb, ub;
+    if(divide) {
+        lb = qMin(m_lb/lbO,qMin(m_lb/ubO,qMin(m_ub/lbO,m_ub/ubO)));
+        ub = qMax(m_lb/lbO,qMax(m_lb/ubO,qMax(m_ub/lbO,m_ub/ubO)));
+    } else {
+        lb = qMin(m_lb*lbO,qMin(m_lb*ubO,qMin(m_ub*lbO,m_ub*ubO)));
+        ub = qMax(m_lb*lbO,qMax(m_lb*ubO,qMax(m_ub*lbO,m_ub*ubO)));
+    }
+
+    // evenly distributed samples for the joint distribution, and for the
+    // operand that is integrated over: this one for a product, the divisor
+    // for a quotient
+    double dz = (ub-lb) / (nSamples-1);
+    vector<double> z(nSamples);
+    double zz = lb;
+    for(int i=0; i<nSamples-1; i++) {
+        z[i] = zz;
+        zz += dz;
+    }
+    z[nSamples-1] = ub;
+
+    double lbI = divide ? lbO : m_lb;
+    double ubI = divide ? ubO : m_ub;
+    double dzI = (ubI-lbI) / (nSamples-1);
+    vector<double> zI(nSamples);
+    zz = lbI;
+    for(int i=0; i<nSamples-1; i++) {
+        zI[i] = zz;
+        zz += dzI;
+    }
+    zI[nSamples-1] = ubI;
+
+    vector<double> newPDF(nSamples);
+    for(int i=0; i<nSamples; i++) {
+        for(int j=0; j<nSamples; j++) {
+            if(divide) {
+                double zo = zI[j];
+                double zt = z[i]*zo;
+                if(zt >= m_lb && zt <= m_ub) {
+                    newPDF[i] += other->pdf(zo) * pdf(zt) * qAbs(zo);
+                }
+                continue;
+            }
+            double zt = zI[j];
+            if(qAbs(zt) >= dzI/2) {
+                double zo = z[i]/zt;
+                if(zo >= lbO && zo <= ubO) {
+                    newPDF[i] += pdf(zt) * other->pdf(zo) / qAbs(zt);
+                }
+            } else {
+                zt = -dzI/2;
+                double zo = z[i]/zt;
+                if(zo >= lbO && zo <= ubO) {
+                    newPDF[i] += pdf(zt) * other->pdf(zo) / qAbs(zt) / 2.0;
+                }
+                zt = dzI/2;
+                zo = z[i]/zt;
+                if(zo >= lbO && zo <= ubO) {
+                    newPDF[i] += pdf(zt) * other->pdf(zo) / qAbs(zt) / 2.0;
+                }
+            }
+        }
+        newPDF[i] *= dzI;
+    }
+
+    // update the distribution
+    m_pdf.swap(newPDF);
+    m_z.swap(z);
+    m_ub = ub;
+    m_lb = lb;
+    m_dz = dz;
+    m_nSamples = nSamples;
+
+    updateCDF();
 }
 
 void IDistribution::reciprocal()
 {
+    invalidateTables();
     double lb,ub;
 
     // Division by zero
@@ -762,7 +1346,7 @@ void IDistribution::reciprocal()
     m_dz = dz;
     m_nSamples = nSamples;
 
-    normalise();
+    updateCDF();
 }
 
 
@@ -832,18 +1416,17 @@ void UniformDistribution::defineBoundaries(double lb, double ub)
 
     IDistribution::defineBoundaries(lb, ub);
 
-    if(m_uniDist != 0) {
-        delete m_uniDist;
-        m_uniDist = 0;
+    if(m_uniDist == 0) {
+        m_uniDist = new boost::math::uniform_distribution<double>(m_lb, m_ub);
+    } else {
+        *m_uniDist = boost::math::uniform_distribution<double>(m_lb, m_ub);
     }
-
-    m_uniDist = new boost::math::uniform_distribution<double>(m_lb, m_ub);
 }
 
 
 double UniformDistribution::sample()
 {
-    return TRAND.randUni(m_ub - m_lb, m_lb);
+    return currentRandomStream()->randUni(m_ub - m_lb, m_lb);
 }
 
 double UniformDistribution::mean()
@@ -893,6 +1476,7 @@ void UniformDistribution::generateZ()
 
 void UniformDistribution::generatePDF()
 {
+    invalidateTables();
     if(m_z.isEmpty()) {
         generateZ();
     }
@@ -964,7 +1548,7 @@ LinearDistribution* LinearDistribution::clone() const
 
 double LinearDistribution::sample()
 {
-    double r = TRAND.randUni();
+    double r = currentRandomStream()->randUni();
     double samp;
     if(m_ascend) {
         samp = m_lb + sqrt(r)*(m_ub-m_lb);
@@ -981,6 +1565,7 @@ void LinearDistribution::generateZ()
 
 void LinearDistribution::generatePDF()
 {
+    invalidateTables();
     if(m_z.isEmpty()) {
         generateZ();
     }
@@ -1024,6 +1609,7 @@ vector<double> LinearDistribution::parameters()
 PeakDistribution::PeakDistribution()
 {
     m_type = Tigon::PeakDistType;
+    m_samplingMethod = GuideTableSampling;
     defineTendencyAndLocality(0.5, 1.0);
 }
 
@@ -1033,18 +1619,20 @@ PeakDistribution::PeakDistribution(const PeakDistribution& dist)
     m_type = Tigon::PeakDistType;
     m_tendency = dist.m_tendency;
     m_locality = dist.m_locality;
-
+    m_sharedTables = dist.m_sharedTables;
 }
 
 PeakDistribution::PeakDistribution(double tendency, double locality)
 {
     m_type = Tigon::PeakDistType;
+    m_samplingMethod = GuideTableSampling;
     defineTendencyAndLocality(tendency, locality);
 }
 
 PeakDistribution::PeakDistribution(vector<double> parameters)
 {
     m_type = Tigon::PeakDistType;
+    m_samplingMethod = GuideTableSampling;
     double tendency = 0.5;
     double locality = 1.0;
     if(parameters.size() > 0) {
@@ -1083,8 +1671,26 @@ void PeakDistribution::defineTendencyAndLocality(double tendency, double localit
 
     m_locality = locality;
 
+    // drop the tables of the previous parameters, so a redefined peak is
+    // tabulated and sampled like a new one
+    invalidateTables();
+    m_z.clear();
+    m_pdf.clear();
+    m_cdf.clear();
+    m_nSamples = 0;
+    m_sharedTables.reset();
+
+    // The grid follows the locality used for the pdf, so localities that
+    // quantise to the same cache entry also get the grid of its key
+    bool   enabled;
+    double tolerance;
+    PeakDistributionCache::instance()->settings(enabled, tolerance);
+    double gridLocality = enabled
+            ? PeakDistributionCache::quantise(m_locality, tolerance)
+            : m_locality;
+
     //TODO: define high resolution at the peak and low at the rest
-    defineResolution(1.0/(m_locality+0.1)/(Tigon::DistNSamples-1));
+    defineResolution(1.0/(gridLocality+0.1)/(Tigon::DistNSamples-1));
 }
 
 double PeakDistribution::tendency() const
@@ -1104,32 +1710,140 @@ void PeakDistribution::generateZ()
 
 void PeakDistribution::generatePDF()
 {
-    using namespace std;
+    invalidateTables();
 
+    // only the default equally spaced grid is shared between instances
+    shared_ptr<const PeakDistributionTables> tables;
     if(m_z.isEmpty()) {
+        tables = sharedTables();
         generateZ();
     }
 
+    if(tables) {
+        // Copied, not shared: normalise() and the arithmetic operations
+        // modify m_pdf and m_cdf in place. Until the pdf is requested,
+        // sample() draws from the shared tables without copying them.
+        m_pdf = tables->pdf;
+        m_cdf = tables->cdf;
+        return;
+    }
+
+    generatePeakPDF(m_tendency, m_locality);
+    normalise();
+}
+
+double PeakDistribution::sample()
+{
+    if(m_samplingMethod != GuideTableSampling || !m_pdf.isEmpty()
+            || !m_z.isEmpty()) {
+        return IDistribution::sample();
+    }
+
+    shared_ptr<const PeakDistributionTables> tables = sharedTables();
+    if(!tables) {
+        return IDistribution::sample();
+    }
+    double r = currentRandomStream()->randUni();
+    return guideTableSample(r, tables->z, tables->cdf, tables->guideTable);
+}
+
+shared_ptr<const PeakDistributionTables> PeakDistribution::sharedTables()
+{
+    // the grid generateEquallySpacedZ() would build
+    int nSamples = (int)((m_ub-m_lb)/m_dz) + 1;
+    if(m_sharedTables && (int)m_sharedTables->z.size() == nSamples
+            && m_sharedTables->z.first() == m_lb
+            && m_sharedTables->z.last()  == m_ub) {
+        return m_sharedTables;
+    }
+    m_sharedTables.reset();
+
+    PeakDistributionCache* cache = PeakDistributionCache::instance();
+    bool   enabled;
+    double tolerance;
+    cache->settings(enabled, tolerance);
+    if(!enabled) {
+        return m_sharedTables;
+    }
+
+    double tendency = PeakDistributionCache::quantise(m_tendency, tolerance);
+    double locality = PeakDistributionCache::quantise(m_locality, tolerance);
+    m_sharedTables = cache->find(tendency, locality, m_lb, m_ub, nSamples);
+    if(m_sharedTables) {
+        return m_sharedTables;
+    }
+
+    // computed on the grid of this instance, which is then left without
+    // a pdf of its own
+    generateZ();
+    generatePeakPDF(tendency, locality);
+    normalise();
+
+    PeakDistributionTables* newTables = new PeakDistributionTables;
+    newTables->z.swap(m_z);
+    newTables->pdf.swap(m_pdf);
+    newTables->cdf.swap(m_cdf);
+    buildGuideTable(newTables->cdf, newTables->guideTable);
+    invalidateTables();
+
+    m_sharedTables = shared_ptr<const PeakDistributionTables>(newTables);
+    cache->insert(tendency, locality, m_lb, m_ub, m_sharedTables);
+    return m_sharedTables;
+}
+
+void PeakDistribution::generatePeakPDF(double tendency, double locality)
+{
+    using namespace std;
+
     m_pdf = vector<double>(m_nSamples);
 
-    double shift = boost::math::constants::pi<double>() * m_tendency;
-    double N = Tigon::DistPeakMinN + m_locality
+    double pi = boost::math::constants::pi<double>();
+    double shift = pi * tendency;
+    double N = Tigon::DistPeakMinN + locality
             * (Tigon::DistPeakMaxN - Tigon::DistPeakMinN);
-    vector<qcomplex> psiN(m_nSamples,qcomplex(0,0));
     double nMax = qMax(3*N,Tigon::DistPeakMinNBasisFunc);
     nMax = qMin(nMax,Tigon::DistPeakMaxNBasisFunc);
-    for(double n=1.0; n<=nMax; n++) {
-        double cNn = sqrt( (qPow(N, n) * exp(-N) / boost::math::factorial<double>(n)));
-        vector<double> psi = eigenFunction(n);
-        for(int i=0; i<m_nSamples; i++) {
-            qcomplex j(0, 1);
-            psiN[i] += cNn * exp(-j*shift*(n+0.5)) * psi[i];
+
+    double Lz = m_ub - m_lb;
+    double An = sqrt(2.0/Lz);
+
+    // The eigenfunctions sin(n*theta_i) are generated with the Chebyshev
+    // recurrence sin((n+1)t) = 2cos(t)sin(nt) - sin((n-1)t), and psiN is
+    // accumulated in split real/imaginary arrays. The end points are zero.
+    int nInner = qMax(m_nSamples-2, 0);
+    const double* z = m_z.data() + 1;
+    vector<double> twoCos(nInner);
+    vector<double> sinPrev(nInner, 0.0);
+    vector<double> sinCur(nInner);
+    vector<double> psiRe(nInner, 0.0);
+    vector<double> psiIm(nInner, 0.0);
+    for(int i=0; i<nInner; i++) {
+        double theta = pi*(z[i]-m_lb)/Lz;
+        twoCos[i] = 2.0*cos(theta);
+        sinCur[i] = sin(theta);
+    }
+
+    // log of the Poisson weight N^n*exp(-N)/n!, updated incrementally
+    double logN = log(N);
+    double logW = -N;
+    for(int n=1; n<=nMax; n++) {
+        logW += logN - log((double)n);
+        double cNn = An * exp(0.5*logW);
+        double cRe =  cNn * cos(shift*(n+0.5));
+        double cIm = -cNn * sin(shift*(n+0.5));
+
+        for(int i=0; i<nInner; i++) {
+            double s = sinCur[i];
+            psiRe[i] += cRe * s;
+            psiIm[i] += cIm * s;
+            sinCur[i]  = twoCos[i]*s - sinPrev[i];
+            sinPrev[i] = s;
         }
     }
-    for(int i=0; i<m_nSamples; i++) {
-        m_pdf[i] = real(conj(psiN[i]) * psiN[i]);
+
+    for(int i=0; i<nInner; i++) {
+        m_pdf[i+1] = psiRe[i]*psiRe[i] + psiIm[i]*psiIm[i];
     }
-    normalise();
 }
 
 vector<double> PeakDistribution::parameters()
@@ -1139,16 +1853,631 @@ vector<double> PeakDistribution::parameters()
     return params;
 }
 
-vector<double> PeakDistribution::eigenFunction(int n)
+
+
+MergedDistribution::MergedDistribution()
+{
+    m_type = Tigon::MergedDistType;
+    m_ratioSum = 0.0;
+}
+
+MergedDistribution::MergedDistribution(const MergedDistribution& dist)
+    : IDistribution(dist)
 {
-    double Lz = m_ub - m_lb;
-    double An = qPow(2.0/Lz, 0.5);
+    m_type = Tigon::MergedDistType;
+    for(int i=0; i<dist.m_distributions.size(); i++) {
+        m_distributions.push_back(dist.m_distributions[i]->clone());
+    }
+    m_ratios   = dist.m_ratios;
+    m_ratioSum = dist.m_ratioSum;
+}
+
+MergedDistribution::~MergedDistribution()
+{
+    for(int i=0; i<m_distributions.size(); i++) {
+        delete m_distributions[i];
+    }
+}
+
+MergedDistribution* MergedDistribution::clone() const
+{
+    return (new MergedDistribution(*this));
+}
+
+double MergedDistribution::sample()
+{
+    if(m_distributions.empty()) {
+        return IDistribution::sample();
+    }
+
+    // composition: choose a component by ratio, then sample it
+    double r = currentRandomStream()->randUni(m_ratioSum);
+    int last = m_distributions.size() - 1;
+    int idx = 0;
+    while(idx < last && r >= m_ratios[idx]) {
+        r -= m_ratios[idx];
+        idx++;
+    }
+    return m_distributions[idx]->sample();
+}
+
+void MergedDistribution::generateZ()
+{
+    if(m_distributions.empty()) {
+        IDistribution::generateZ();
+        return;
+    }
+
+    m_z.clear();
+    for(int i=0; i<m_distributions.size(); i++) {
+        addZSamplesOfOneDistribution(m_distributions[i]);
+    }
+
+    if(m_z.size() < 2) {
+        IDistribution::generateZ();
+    } else {
+        // sorts and removes duplicates
+        defineZ(m_z);
+    }
+}
+
+void MergedDistribution::generatePDF()
+{
+    invalidateTables();
+
+    if(m_z.isEmpty()) {
+        generateZ();
+    }
+
+    if(m_distributions.empty()) {
+        IDistribution::generatePDF();
+        return;
+    }
+
+    m_pdf = vector<double>(m_nSamples, 0.0);
+    for(int i=0; i<m_distributions.size(); i++) {
+        addOnePDF(m_distributions[i], m_ratios[i]);
+    }
+    normalise();
+}
+
+void MergedDistribution::appendDistribution(IDistribution* d)
+{
+    appendDistribution(d, 1.0);
+}
+
+void MergedDistribution::appendDistribution(IDistribution* d, double ratio)
+{
+    if(d == 0) {
+        return;
+    }
+    if(ratio <= 0.0) {
+        // owned from the call on, even when it is not appended
+        delete d;
+        return;
+    }
+    m_distributions.push_back(d);
+    m_ratios.push_back(ratio);
+    resetMergedGrid();
+}
+
+void MergedDistribution::removeDistribution(IDistribution* d)
+{
+    for(int i=0; i<m_distributions.size(); i++) {
+        if(m_distributions[i] == d) {
+            removeDistribution(i);
+            return;
+        }
+    }
+}
+
+void MergedDistribution::removeDistribution(int idx)
+{
+    if(idx < 0 || idx >= m_distributions.size()) {
+        return;
+    }
+    delete m_distributions[idx];
+    m_distributions.erase(m_distributions.begin() + idx);
+    m_ratios.erase(m_ratios.begin() + idx);
+    resetMergedGrid();
+}
+
+void MergedDistribution::changeRatio(IDistribution* d, double newRatio)
+{
+    for(int i=0; i<m_distributions.size(); i++) {
+        if(m_distributions[i] == d) {
+            changeRatio(i, newRatio);
+            return;
+        }
+    }
+}
+
+void MergedDistribution::changeRatio(int idx, double newRatio)
+{
+    if(idx < 0 || idx >= m_ratios.size() || newRatio <= 0.0) {
+        return;
+    }
+    m_ratios[idx] = newRatio;
+    resetMergedGrid();
+}
+
+int MergedDistribution::nDistributions() const
+{
+    return m_distributions.size();
+}
+
+IDistribution* MergedDistribution::distribution(int idx) const
+{
+    if(idx < 0 || idx >= m_distributions.size()) {
+        return 0;
+    }
+    return m_distributions[idx];
+}
+
+void MergedDistribution::updateDistributions()
+{
+    resetMergedGrid();
+}
+
+void MergedDistribution::defineBoundaries(double lb, double ub)
+{
+    mergeComponents();
+    IDistribution::defineBoundaries(lb, ub);
+    collapse();
+}
+
+void MergedDistribution::negate()
+{
+    mergeComponents();
+    IDistribution::negate();
+    collapse();
+}
+
+void MergedDistribution::add(double num)
+{
+    mergeComponents();
+    IDistribution::add(num);
+    collapse();
+}
+
+void MergedDistribution::add(const IDistribution* other)
+{
+    mergeComponents();
+    IDistribution::add(other);
+    collapse();
+}
+
+void MergedDistribution::add(const vector<const IDistribution*>& others)
+{
+    mergeComponents();
+    IDistribution::add(others);
+    collapse();
+}
+
+void MergedDistribution::multiply(double num)
+{
+    mergeComponents();
+    IDistribution::multiply(num);
+    collapse();
+}
+
+void MergedDistribution::multiply(const IDistribution* other)
+{
+    mergeComponents();
+    IDistribution::multiply(other);
+    collapse();
+}
+
+void MergedDistribution::divide(const IDistribution* other)
+{
+    mergeComponents();
+    IDistribution::divide(other);
+    collapse();
+}
+
+void MergedDistribution::reciprocal()
+{
+    mergeComponents();
+    IDistribution::reciprocal();
+    collapse();
+}
+
+void MergedDistribution::affineTransform(double scale, double shift)
+{
+    mergeComponents();
+    IDistribution::affineTransform(scale, shift);
+    collapse();
+}
+
+void MergedDistribution::addZSamplesOfOneDistribution(IDistribution* d)
+{
+    vector<double> z = d->zSamples();
+    m_z.insert(m_z.end(), z.begin(), z.end());
+}
+
+void MergedDistribution::addOnePDF(IDistribution* d, double ratio)
+{
+    // pdf(z) is zero outside the boundaries of d
+    for(int i=0; i<m_nSamples; i++) {
+        m_pdf[i] += ratio * d->pdf(m_z[i]);
+    }
+}
+
+void MergedDistribution::resetMergedGrid()
+{
+    invalidateTables();
+    m_z.clear();
+    m_pdf.clear();
+    m_cdf.clear();
+    m_nSamples = 0;
+
+    m_ratioSum = 0.0;
+    for(int i=0; i<m_ratios.size(); i++) {
+        m_ratioSum += m_ratios[i];
+    }
+
+    if(m_distributions.empty()) {
+        return;
+    }
+    m_lb = m_distributions[0]->lowerBound();
+    m_ub = m_distributions[0]->upperBound();
+    double dz = m_distributions[0]->resolution();
+    for(int i=1; i<m_distributions.size(); i++) {
+        m_lb = qMin(m_lb, m_distributions[i]->lowerBound());
+        m_ub = qMax(m_ub, m_distributions[i]->upperBound());
+        dz   = qMin(dz,   m_distributions[i]->resolution());
+    }
+    // the finest component resolution, over the merged range
+    defineResolution(dz);
+}
+
+void MergedDistribution::mergeComponents()
+{
+    if(m_pdf.isEmpty() || m_pdf.size() != m_nSamples) {
+        generatePDF();
+    }
+}
+
+void MergedDistribution::collapse()
+{
+    // the grid is now the only description of the distribution
+    IDistribution* merged = new IDistribution(*this);
+    for(int i=0; i<m_distributions.size(); i++) {
+        delete m_distributions[i];
+    }
+    m_distributions.clear();
+    m_ratios.clear();
+    m_distributions.push_back(merged);
+    m_ratios.push_back(1.0);
+    m_ratioSum = 1.0;
+}
+
+
+
+SampledDistribution::SampledDistribution()
+{
+    m_type = Tigon::GenericDistType;
+}
+
+SampledDistribution::SampledDistribution(const SampledDistribution& dist)
+    : IDistribution(dist)
+{
+    m_type = Tigon::GenericDistType;
+    m_samples = dist.m_samples;
+}
+
+SampledDistribution::SampledDistribution(const IDistribution* d, int nSamples)
+{
+    m_type = Tigon::GenericDistType;
+    if(d == 0 || nSamples < 1) {
+        return;
+    }
+    IDistribution* source = d->clone();
+    m_samples.resize(nSamples);
+    for(int i=0; i<nSamples; i++) {
+        m_samples[i] = source->sample();
+    }
+    delete source;
+    resetGrid();
+}
+
+SampledDistribution::SampledDistribution(vector<double> samples)
+{
+    m_type = Tigon::GenericDistType;
+    m_samples = samples;
+    resetGrid();
+}
+
+SampledDistribution::~SampledDistribution()
+{
+
+}
+
+SampledDistribution* SampledDistribution::clone() const
+{
+    return (new SampledDistribution(*this));
+}
+
+double SampledDistribution::sample()
+{
+    if(m_samples.empty()) {
+        return IDistribution::sample();
+    }
+    int n = m_samples.size();
+    int idx = qMin((int)(currentRandomStream()->randUni()*n), n-1);
+    return m_samples[idx];
+}
+
+double SampledDistribution::mean()
+{
+    if(m_samples.empty()) {
+        return IDistribution::mean();
+    }
+    double sum = 0.0;
+    for(int i=0; i<m_samples.size(); i++) {
+        sum += m_samples[i];
+    }
+    return sum / m_samples.size();
+}
+
+double SampledDistribution::variance()
+{
+    if(m_samples.empty()) {
+        return IDistribution::variance();
+    }
+    double m = mean();
+    double sum = 0.0;
+    for(int i=0; i<m_samples.size(); i++) {
+        double d = m_samples[i] - m;
+        sum += d*d;
+    }
+    return sum / m_samples.size();
+}
+
+void SampledDistribution::generateZ()
+{
+    generateEquallySpacedZ();
+}
+
+void SampledDistribution::generatePDF()
+{
+    invalidateTables();
+
+    if(m_z.isEmpty()) {
+        generateZ();
+    }
+
+    if(m_samples.empty()) {
+        IDistribution::generatePDF();
+        return;
+    }
+
+    // linear binning: each sample is shared by its two neighbouring nodes
+    m_pdf = vector<double>(m_nSamples, 0.0);
+    int last = m_nSamples - 1;
+    for(int i=0; i<m_samples.size(); i++) {
+        double pos = (m_samples[i] - m_lb) / m_dz;
+        pos = qMax(0.0, qMin(pos, (double)last));
+        int j = qMin((int)pos, last-1);
+        double w = pos - j;
+        m_pdf[j]   += 1.0 - w;
+        m_pdf[j+1] += w;
+    }
+    // the end nodes only collect mass from half an interval
+    m_pdf[0]    *= 2.0;
+    m_pdf[last] *= 2.0;
+    normalise();
+}
+
+const vector<double>& SampledDistribution::samples() const
+{
+    return m_samples;
+}
+
+int SampledDistribution::poolSize() const
+{
+    return m_samples.size();
+}
+
+void SampledDistribution::defineBoundaries(double lb, double ub)
+{
+    if(m_samples.empty()) {
+        IDistribution::defineBoundaries(lb, ub);
+        return;
+    }
+    if(!(ub > lb)) {
+        // a point mass, widened by resetGrid() as by the grid version
+        std::fill(m_samples.begin(), m_samples.end(), lb);
+        resetGrid();
+        return;
+    }
+
+    // affine map of the samples from [m_lb m_ub] to [lb ub]
+    double ratio = (ub - lb) / (m_ub - m_lb);
+    double oldLb = m_lb;
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] = lb + ratio * (m_samples[i] - oldLb);
+    }
+    resetGrid();
+}
+
+void SampledDistribution::negate()
+{
+    if(m_samples.empty()) {
+        IDistribution::negate();
+        return;
+    }
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] = -m_samples[i];
+    }
+    resetGrid();
+}
+
+void SampledDistribution::add(double num)
+{
+    if(m_samples.empty()) {
+        IDistribution::add(num);
+        return;
+    }
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] += num;
+    }
+    resetGrid();
+}
+
+void SampledDistribution::add(const IDistribution* other)
+{
+    if(m_samples.empty()) {
+        IDistribution::add(other);
+        return;
+    }
+    vector<double> o = pairedSamples(other);
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] += o[i];
+    }
+    resetGrid();
+}
+
+void SampledDistribution::add(const vector<const IDistribution*>& others)
+{
+    if(m_samples.empty()) {
+        IDistribution::add(others);
+        return;
+    }
+    // one pass per term, but a single rebuild of the grid
+    for(int k=0; k<others.size(); k++) {
+        vector<double> o = pairedSamples(others[k]);
+        for(int i=0; i<m_samples.size(); i++) {
+            m_samples[i] += o[i];
+        }
+    }
+    resetGrid();
+}
+
+void SampledDistribution::multiply(double num)
+{
+    if(m_samples.empty()) {
+        IDistribution::multiply(num);
+        return;
+    }
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] *= num;
+    }
+    resetGrid();
+}
+
+void SampledDistribution::multiply(const IDistribution* other)
+{
+    if(m_samples.empty()) {
+        IDistribution::multiply(other);
+        return;
+    }
+    vector<double> o = pairedSamples(other);
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] *= o[i];
+    }
+    resetGrid();
+}
+
+void SampledDistribution::divide(const IDistribution* other)
+{
+    if(m_samples.empty()) {
+        IDistribution::divide(other);
+        return;
+    }
+    vector<double> o = pairedSamples(other);
+    if(std::find(o.begin(), o.end(), 0.0) != o.end()) {
+        // the quotient is unbounded, as for a divisor whose support
+        // contains zero on the grid
+        dropPool();
+        IDistribution::divide(other);
+        return;
+    }
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] /= o[i];
+    }
+    resetGrid();
+}
+
+void SampledDistribution::reciprocal()
+{
+    if(m_samples.empty()) {
+        IDistribution::reciprocal();
+        return;
+    }
+    if(std::find(m_samples.begin(), m_samples.end(), 0.0)
+            != m_samples.end()) {
+        dropPool();
+        IDistribution::reciprocal();
+        return;
+    }
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] = 1.0 / m_samples[i];
+    }
+    resetGrid();
+}
 
-    vector<double> psi(m_nSamples, 0);
-    for(int i=1; i<m_nSamples-1; i++) {
-        psi[i] = An*sin(boost::math::constants::pi<double>()*n*(m_z[i]-m_lb)/Lz);
+void SampledDistribution::affineTransform(double scale, double shift)
+{
+    if(m_samples.empty()) {
+        IDistribution::affineTransform(scale, shift);
+        return;
+    }
+    for(int i=0; i<m_samples.size(); i++) {
+        m_samples[i] = scale*m_samples[i] + shift;
+    }
+    resetGrid();
+}
+
+vector<double> SampledDistribution::pairedSamples(
+        const IDistribution* other) const
+{
+    int n = m_samples.size();
+    const SampledDistribution* sampled =
+            dynamic_cast<const SampledDistribution*>(other);
+    if(sampled != 0 && sampled != this && sampled->poolSize() == n) {
+        return sampled->samples();
     }
-    return psi;
+
+    // independent draws, also for other == this
+    IDistribution* source = other->clone();
+    vector<double> o(n);
+    for(int i=0; i<n; i++) {
+        o[i] = source->sample();
+    }
+    delete source;
+    return o;
+}
+
+void SampledDistribution::dropPool()
+{
+    // the binned pdf becomes the description of the distribution
+    if(m_pdf.isEmpty()) {
+        generatePDF();
+    }
+    m_samples.clear();
+}
+
+void SampledDistribution::resetGrid()
+{
+    invalidateTables();
+    m_z.clear();
+    m_pdf.clear();
+    m_cdf.clear();
+    m_nSamples = 0;
+
+    if(m_samples.empty()) {
+        return;
+    }
+    double lb = m_samples[0];
+    double ub = m_samples[0];
+    for(int i=1; i<m_samples.size(); i++) {
+        lb = qMin(lb, m_samples[i]);
+        ub = qMax(ub, m_samples[i]);
+    }
+    // also widens a degenerate interval
+    IDistribution::defineBoundaries(lb, ub);
+    defineResolution((m_ub-m_lb)/(Tigon::DistNSamples-1));
 }
 
 } // namespace CODeM
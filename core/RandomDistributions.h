@@ -17,10 +17,21 @@
 #define DISTRIBUTIONS_H
 
 #include <vector>
+#include <memory>
 using namespace std;
 
 namespace CODeM {
 class AbstractInterpolator;
+class DistributionExpression;
+struct PeakDistributionTables;
+
+// Engines used by IDistribution::sample() to invert the tabulated cdf
+enum SamplingMethod {
+    // binary search/hunt of the quantile interpolator
+    InterpolatorSampling,
+    // Chen-Asau guide table: expected constant time per draw
+    GuideTableSampling
+};
 
 class IDistribution
 {
@@ -36,6 +47,13 @@ public:
 
     virtual vector<double> parameters();
 
+    // Builds the inverse-CDF table ahead of the first draw. The table is
+    // reused by sample(), median() and percentile() until the state of
+    // the distribution changes.
+    void           prepareForSampling();
+    void           defineSamplingMethod(SamplingMethod method);
+    SamplingMethod samplingMethod()               const;
+
     virtual double sample();
     virtual double mean();
     virtual double variance();
@@ -68,16 +86,72 @@ public:
     virtual void negate();
     virtual void add(double num);
     virtual void add(const IDistribution* other);
+    // The sum with several independent distributions at once: every pdf is
+    // sampled once on a common spacing, and all are convolved together.
+    virtual void add(const vector<const IDistribution*>& others);
     virtual void subtract(double num);
     virtual void subtract(const IDistribution* other);
     virtual void multiply(double num);
     virtual void multiply(const IDistribution* other);
     virtual void divide(double num);
     virtual void divide(const IDistribution* other);
-    void reciprocal();
+    virtual void reciprocal();
+    // scale*X + shift with a single remap of the z samples
+    virtual void affineTransform(double scale, double shift);
+
+    // Whether arithmetic leaves the pdf unnormalised; only ever true on the
+    // intermediate results of a DistributionExpression
+    bool isCDFDeferred()                  const;
 
 
 protected:
+    friend class DistributionExpression;
+
+    // While deferred, arithmetic operations leave the pdf unnormalised and
+    // the cdf empty, and the pdf accessors and moments do not normalise it
+    // either. Turning it off rebuilds it.
+    void defineDeferredCDF(bool deferred);
+    // Re-tabulates the pdf on nSamples equally spaced points over the same
+    // support, by linear interpolation of the current table
+    void resample(int nSamples);
+    // Marks the cached pdf/cdf/quantile tables as stale. Called by every
+    // method that changes m_z, m_pdf or m_cdf.
+    void invalidateTables();
+    // calculateCDF(), or only a cdf reset while the cdf is deferred
+    void updateCDF();
+    // Convolves the pdf with those of others, each sampled at a spacing of
+    // the widest support over Tigon::DistConvNSamples
+    void convolveWith(const vector<const IDistribution*>& others);
+    // Product (or quotient) with a distribution when both supports are
+    // strictly positive or strictly negative: the densities of log|X| and
+    // log|Y| are convolved, which is O(n*log(n)) instead of O(n^2). The
+    // result has nSamples points; the log grid has nLogSamples intervals.
+    // multiply() and divide() pass Tigon::DistMultNSamples and
+    // Tigon::DistConvNSamples.
+    void logDomainMultiply(const IDistribution* other, bool divide,
+                           int nSamples, int nLogSamples);
+    // Product (or quotient) when a support contains zero. The supports are
+    // split into one-signed pieces, combined by logDomainMultiply()'s
+    // convolution, and a narrow strip around zero that is taken as uniform
+    // and combined in closed form. The divisor must be one-signed.
+    void mixedSignMultiply(const IDistribution* other, bool divide,
+                           int nSamples, int nLogSamples);
+    // The quadratic method for supports containing zero: every output point
+    // sums the joint density over nSamples points of this distribution
+    // (product) or of the divisor (quotient). O(n^2), but more accurate
+    // than mixedSignMultiply() for densities with jumps, and as fast for
+    // small n.
+    void gridMultiply(const IDistribution* other, bool divide, int nSamples);
+    // Whether multiply() and divide() take mixedSignMultiply() rather than
+    // gridMultiply(): nSamples is large enough and neither density jumps
+    bool useStripIntegration(const IDistribution* other, int nSamples);
+    // Guide table of a tabulated cdf, and the inversion of r through it
+    static void   buildGuideTable(const vector<double>& cdf,
+                                  vector<int>& guideTable);
+    static double guideTableSample(double r, const vector<double>& z,
+                                   const vector<double>& cdf,
+                                   const vector<int>& guideTable);
+
     Tigon::DistributionType  m_type;
     double                    m_dz;
     double                    m_lb;
@@ -89,6 +163,12 @@ protected:
     AbstractInterpolator*    m_quantileInterpolator;
     AbstractInterpolator*    m_pdfInterpolator;
     AbstractInterpolator*    m_cdfInterpolator;
+    bool                     m_isQuantileUpToDate;
+    bool                     m_isPdfUpToDate;
+    bool                     m_isCdfUpToDate;
+    SamplingMethod           m_samplingMethod;
+    bool                     m_isCDFDeferred;
+    vector<int>              m_guideTable;
 
 };
 
@@ -169,6 +249,8 @@ public:
     double tendency()  const;
     double locality()  const;
 
+    double sample();
+
     void generateZ();
     void generatePDF();
 
@@ -177,11 +259,22 @@ public:
 private:
     double m_tendency;
     double m_locality;
+    // cache entry of the default grid; found, or computed and inserted, on
+    // the first use and kept while the grid keeps its key
+    shared_ptr<const PeakDistributionTables> m_sharedTables;
 
-    vector<double> eigenFunction(int n);
+    shared_ptr<const PeakDistributionTables> sharedTables();
+
+    // fills m_pdf on the current grid, without normalising
+    void generatePeakPDF(double tendency, double locality);
 };
 
 
+// A mixture of distributions. The merged distribution takes ownership of the
+// appended distributions, and deletes one appended with a ratio <= 0.
+// Sampling picks a component by its ratio and delegates to that component's
+// sample(); the union-of-z grid is only built when the pdf or cdf is
+// requested.
 class MergedDistribution : public IDistribution
 {
 public:
@@ -191,6 +284,8 @@ public:
 
     MergedDistribution* clone() const;
 
+    double sample();
+
     void generateZ();
     void generatePDF();
 
@@ -204,12 +299,85 @@ public:
     void changeRatio(IDistribution* d, double newRatio);
     void changeRatio(int             idx, double newRatio);
 
+    int  nDistributions() const;
+    // A component, still owned by the merged distribution, or 0 for an
+    // invalid index. Call updateDistributions() after changing one.
+    IDistribution* distribution(int idx) const;
+    void           updateDistributions();
+
+    // operations on the merged grid replace the components by the result
+    void defineBoundaries(double lb, double ub);
+    void negate();
+    void add(double num);
+    void add(const IDistribution* other);
+    void add(const vector<const IDistribution*>& others);
+    void multiply(double num);
+    void multiply(const IDistribution* other);
+    void divide(const IDistribution* other);
+    void reciprocal();
+    void affineTransform(double scale, double shift);
+
 private:
     vector<IDistribution*> m_distributions;
     vector<double>             m_ratios;
+    double                     m_ratioSum;
 
     void addZSamplesOfOneDistribution(IDistribution* d);
     void addOnePDF(IDistribution* d,       double ratio);
+    void resetMergedGrid();
+    void mergeComponents();
+    void collapse();
+};
+
+
+// A distribution represented by a pool of samples. Arithmetic is applied
+// element-wise to the samples, so a chain of operations costs O(N) each,
+// and the z/pdf grid is only estimated (by linear binning) when requested.
+// Two sampled distributions of the same size are paired by index; this
+// keeps the dependence between distributions derived from the same pool.
+// Any other distribution is first sampled N times. Without a pool the
+// operations act on the grid, as for any IDistribution; a division by zero
+// in the pool also continues on the grid, which gives the unbounded result
+// of a divisor whose support contains zero.
+class SampledDistribution : public IDistribution
+{
+public:
+    SampledDistribution();
+    SampledDistribution(const SampledDistribution& dist);
+    SampledDistribution(const IDistribution* d, int nSamples = 10000);
+    SampledDistribution(vector<double> samples);
+    virtual ~SampledDistribution();
+
+    SampledDistribution* clone() const;
+
+    double sample();
+    double mean();
+    double variance();
+
+    void generateZ();
+    void generatePDF();
+
+    const vector<double>& samples() const;
+    int  poolSize()                 const;
+
+    void defineBoundaries(double lb, double ub);
+    void negate();
+    void add(double num);
+    void add(const IDistribution* other);
+    void add(const vector<const IDistribution*>& others);
+    void multiply(double num);
+    void multiply(const IDistribution* other);
+    void divide(const IDistribution* other);
+    void reciprocal();
+    void affineTransform(double scale, double shift);
+
+private:
+    vector<double> m_samples;
+
+    vector<double> pairedSamples(const IDistribution* other) const;
+    // bins the pool into the pdf and continues as a grid distribution
+    void dropPool();
+    void resetGrid();
 };
 
 } // namespace CODeM
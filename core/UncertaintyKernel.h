@@ -20,6 +20,7 @@
 
 
 #include <vector>
+#include <core/utils/Span.h>
 class BoxConstraintsData;
 
 namespace CODeM {
@@ -83,6 +84,90 @@ private:
     void calcDirectionAndDistance();
 };
 
+// A non-owning, allocation-free variant of UncertaintyKernel for the
+// per-sample hot path. It keeps views of caller memory instead of copies:
+// the objective vector with the ideal point and the inverse ranges
+// 1/(antiIdeal-ideal), and optionally the decision vector with the lower
+// bounds and inverse ranges of the box. The normalised distance, the
+// 1-norm direction and the symmetry are computed in a single pass by the
+// constructor. The direction is only stored when a buffer of
+// outputs.size() values is given; direction() is a view of that buffer.
+// The symmetry is in [0,1]: 1 on the diagonal, 0 on an axis, and 1 at the
+// ideal point, which has no direction. The owning UncertaintyKernel keeps
+// its original symmetry, which is (1/(1-1/sqrt(n)))^2 at the ideal point.
+// The view and the batch functions are defined in UncertaintyKernelView.cpp,
+// which does not depend on Tigon.
+class UncertaintyKernelView
+{
+public:
+    UncertaintyKernelView(ConstDoubleSpan outputs,
+                          ConstDoubleSpan ideal,
+                          ConstDoubleSpan invRange,
+                          double lb,
+                          double ub,
+                          double* direction = 0);
+    UncertaintyKernelView(ConstDoubleSpan inputs,
+                          ConstDoubleSpan inputLowerBounds,
+                          ConstDoubleSpan inputInvRange,
+                          ConstDoubleSpan outputs,
+                          ConstDoubleSpan ideal,
+                          ConstDoubleSpan invRange,
+                          double lb,
+                          double ub,
+                          double* direction = 0);
+
+    double proximity()          const;
+    double symmetry()           const;
+    double distance()           const;
+    double oComponent(int idx)  const;
+    double dComponent(int idx)  const;
+
+    ConstDoubleSpan direction() const;
+
+private:
+    void calcDirectionAndDistance(double* direction);
+
+    ConstDoubleSpan m_inputs;
+    ConstDoubleSpan m_inputLowerBounds;
+    ConstDoubleSpan m_inputInvRange;
+    ConstDoubleSpan m_outputs;
+    ConstDoubleSpan m_ideal;
+    ConstDoubleSpan m_invRange;
+    ConstDoubleSpan m_direction;
+    double          m_distance;
+    double          m_symmetry;
+    double          m_lb;
+    double          m_ub;
+};
+
+// The UncertaintyKernelView quantities of a population of nInd objective
+// vectors, computed in one sweep that vectorises over the individuals. The
+// nInd x nObj objective matrix is stored transposed, objective by
+// objective (SoA): objective m of individual j is outputs[m*nInd + j].
+// ideal and invRange hold nObj values. proximity and symmetry receive nInd
+// values, and direction nInd x nObj values in the layout of outputs; any
+// of them may be 0 when not needed. The results are identical to those of
+// UncertaintyKernelView when built with -ffp-contract=off.
+void uncertaintyKernelBatch(const double* outputs, int nInd, int nObj,
+                            const double* ideal, const double* invRange,
+                            double lb, double ub,
+                            double* proximity, double* symmetry,
+                            double* direction = 0);
+
+// As uncertaintyKernelBatch, for a row-major nInd x nObj matrix: objective
+// m of individual j is outputs[j*nObj + m], and so is its direction
+// component. This is the layout of evaluatePopulation() with nSamp = 1.
+// Each row is evaluated by an UncertaintyKernelView.
+void uncertaintyKernelRows(const double* outputs, int nInd, int nObj,
+                           const double* ideal, const double* invRange,
+                           double lb, double ub,
+                           double* proximity, double* symmetry,
+                           double* direction = 0);
+
+// 1/(ub[i]-lb[i]) for each element, written to invRange
+void inverseRanges(const vector<double>& lb, const vector<double>& ub,
+                   vector<double>& invRange);
+
 } // namespace CODeM
 
 #endif // UNCERTAINTYKERNEL_H
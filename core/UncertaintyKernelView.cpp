@@ -0,0 +1,286 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#include <core/UncertaintyKernel.h>
+#include <algorithm>
+#include <cmath>
+
+namespace CODeM {
+
+UncertaintyKernelView::UncertaintyKernelView(ConstDoubleSpan outputs,
+                                             ConstDoubleSpan ideal,
+                                             ConstDoubleSpan invRange,
+                                             double lb,
+                                             double ub,
+                                             double* direction)
+    : m_outputs(outputs),
+      m_ideal(ideal),
+      m_invRange(invRange),
+      m_distance(0.0),
+      m_symmetry(0.0),
+      m_lb(0.0),
+      m_ub(1.0)
+{
+    if(ub > lb) {
+        m_lb = lb;
+        m_ub = ub;
+    }
+    calcDirectionAndDistance(direction);
+}
+
+UncertaintyKernelView::UncertaintyKernelView(ConstDoubleSpan inputs,
+                                             ConstDoubleSpan inputLowerBounds,
+                                             ConstDoubleSpan inputInvRange,
+                                             ConstDoubleSpan outputs,
+                                             ConstDoubleSpan ideal,
+                                             ConstDoubleSpan invRange,
+                                             double lb,
+                                             double ub,
+                                             double* direction)
+    : m_inputs(inputs),
+      m_inputLowerBounds(inputLowerBounds),
+      m_inputInvRange(inputInvRange),
+      m_outputs(outputs),
+      m_ideal(ideal),
+      m_invRange(invRange),
+      m_distance(0.0),
+      m_symmetry(0.0),
+      m_lb(0.0),
+      m_ub(1.0)
+{
+    if(ub > lb) {
+        m_lb = lb;
+        m_ub = ub;
+    }
+    calcDirectionAndDistance(direction);
+}
+
+void UncertaintyKernelView::calcDirectionAndDistance(double* direction)
+{
+    int n = m_outputs.size();
+    if(n < 2 || m_ideal.size() != n || m_invRange.size() != n) {
+        return;
+    }
+
+    // normalise to the unit box, and accumulate the 2-norm and the 1-norm
+    double sumSq  = 0.0;
+    double sumAbs = 0.0;
+    for(int i=0; i<n; i++) {
+        double v = (m_outputs[i] - m_ideal[i]) * m_invRange[i];
+        sumSq  += v * v;
+        sumAbs += std::abs(v);
+        if(direction != 0) {
+            direction[i] = v;
+        }
+    }
+    m_distance = std::sqrt(sumSq);
+
+    // the 2-norm of the direction on the k-1 simplex is |v|_2 / |v|_1. At
+    // the ideal point there is no direction, and the symmetry is taken as
+    // that of the diagonal, 1. Rounding can put |v|_2 / |v|_1 just below
+    // 1/sqrt(n), hence the clamp.
+    double euclideanDist = 1.0/std::sqrt(n);
+    if(sumAbs > 0.0) {
+        euclideanDist = m_distance / sumAbs;
+    }
+    double symmetryVal = (1.0 - euclideanDist) / (1.0 - 1.0/std::sqrt(n));
+    m_symmetry = std::min(1.0, symmetryVal * symmetryVal);
+
+    if(direction != 0) {
+        if(sumAbs > 0.0) {
+            double invSum = 1.0 / sumAbs;
+            for(int i=0; i<n; i++) {
+                direction[i] *= invSum;
+            }
+        }
+        m_direction = ConstDoubleSpan(direction, n);
+    }
+}
+
+double UncertaintyKernelView::proximity() const
+{
+    if(m_distance <= m_lb) {
+        return 0.0;
+    } else if(m_distance >= m_ub) {
+        return 1.0;
+    } else {
+        return (m_distance - m_lb) / (m_ub - m_lb);
+    }
+}
+
+double UncertaintyKernelView::symmetry() const
+{
+    return m_symmetry;
+}
+
+double UncertaintyKernelView::distance() const
+{
+    return m_distance;
+}
+
+double UncertaintyKernelView::oComponent(int idx) const
+{
+    if(idx < 0 || idx >= m_outputs.size()) {
+        return -1.0;
+    }
+    return (m_outputs[idx] - m_ideal[idx]) * m_invRange[idx];
+}
+
+double UncertaintyKernelView::dComponent(int idx) const
+{
+    if(idx < 0 || idx >= m_inputs.size()) {
+        return -1.0;
+    }
+    return (m_inputs[idx] - m_inputLowerBounds[idx]) * m_inputInvRange[idx];
+}
+
+ConstDoubleSpan UncertaintyKernelView::direction() const
+{
+    return m_direction;
+}
+
+namespace {
+// individuals per block of uncertaintyKernelBatch; the per-individual sums
+// of a block stay on the stack
+const int KernelBatchBlockSize = 256;
+}
+
+void uncertaintyKernelBatch(const double* outputs, int nInd, int nObj,
+                            const double* ideal, const double* invRange,
+                            double lb, double ub,
+                            double* proximity, double* symmetry,
+                            double* direction)
+{
+    if(outputs == 0 || ideal == 0 || invRange == 0 || nInd <= 0 || nObj < 2) {
+        return;
+    }
+    if(!(ub > lb)) {
+        lb = 0.0;
+        ub = 1.0;
+    }
+    double invSqrtN = 1.0/std::sqrt(nObj);
+    double symDenom = 1.0 - invSqrtN;
+
+    double sumSq[KernelBatchBlockSize];
+    double sumAbs[KernelBatchBlockSize];
+    double euclidean[KernelBatchBlockSize];
+
+    for(int j0=0; j0<nInd; j0 += KernelBatchBlockSize) {
+        int nb = std::min(KernelBatchBlockSize, nInd - j0);
+
+        for(int j=0; j<nb; j++) {
+            sumSq[j]  = 0.0;
+            sumAbs[j] = 0.0;
+        }
+
+        // normalise to the unit box, and accumulate the 2-norm and 1-norm
+        for(int m=0; m<nObj; m++) {
+            const double* o = outputs + m*nInd + j0;
+            double id  = ideal[m];
+            double inv = invRange[m];
+            if(direction != 0) {
+                double* d = direction + m*nInd + j0;
+                for(int j=0; j<nb; j++) {
+                    double v = (o[j] - id) * inv;
+                    sumSq[j]  += v * v;
+                    sumAbs[j] += std::abs(v);
+                    d[j] = v;
+                }
+            } else {
+                for(int j=0; j<nb; j++) {
+                    double v = (o[j] - id) * inv;
+                    sumSq[j]  += v * v;
+                    sumAbs[j] += std::abs(v);
+                }
+            }
+        }
+
+        // sumSq becomes the distance, euclidean the 2-norm of the simplex
+        // direction (that of the diagonal at the ideal point) and sumAbs
+        // the scaling to the k-1 simplex
+        for(int j=0; j<nb; j++) {
+            double dist = std::sqrt(sumSq[j]);
+            bool nonZero = sumAbs[j] > 0.0;
+            euclidean[j] = nonZero ? dist / sumAbs[j] : invSqrtN;
+            sumAbs[j]    = nonZero ? 1.0 / sumAbs[j] : 1.0;
+            sumSq[j]     = dist;
+        }
+
+        if(proximity != 0) {
+            double* prox = proximity + j0;
+            for(int j=0; j<nb; j++) {
+                double dist = sumSq[j];
+                prox[j] = (dist <= lb) ? 0.0 :
+                          (dist >= ub) ? 1.0 : (dist - lb) / (ub - lb);
+            }
+        }
+
+        if(symmetry != 0) {
+            double* sym = symmetry + j0;
+            for(int j=0; j<nb; j++) {
+                double symmetryVal = (1.0 - euclidean[j]) / symDenom;
+                sym[j] = std::min(1.0, symmetryVal * symmetryVal);
+            }
+        }
+
+        if(direction != 0) {
+            for(int m=0; m<nObj; m++) {
+                double* d = direction + m*nInd + j0;
+                for(int j=0; j<nb; j++) {
+                    d[j] *= sumAbs[j];
+                }
+            }
+        }
+    }
+}
+
+void uncertaintyKernelRows(const double* outputs, int nInd, int nObj,
+                           const double* ideal, const double* invRange,
+                           double lb, double ub,
+                           double* proximity, double* symmetry,
+                           double* direction)
+{
+    if(outputs == 0 || ideal == 0 || invRange == 0 || nInd <= 0 || nObj < 2) {
+        return;
+    }
+    ConstDoubleSpan idealSpan(ideal, nObj);
+    ConstDoubleSpan invRangeSpan(invRange, nObj);
+    for(int j=0; j<nInd; j++) {
+        double* d = (direction != 0) ? direction + (size_t)j*nObj : 0;
+        UncertaintyKernelView uk(ConstDoubleSpan(outputs + (size_t)j*nObj,
+                                                 nObj),
+                                 idealSpan, invRangeSpan, lb, ub, d);
+        if(proximity != 0) {
+            proximity[j] = uk.proximity();
+        }
+        if(symmetry != 0) {
+            symmetry[j] = uk.symmetry();
+        }
+    }
+}
+
+void inverseRanges(const vector<double>& lb, const vector<double>& ub,
+                   vector<double>& invRange)
+{
+    if(lb.size() != ub.size()) {
+        return;
+    }
+    invRange.resize(lb.size());
+    for(int i=0; i<lb.size(); i++) {
+        invRange[i] = 1.0 / (ub[i] - lb[i]);
+    }
+}
+
+} // namespace CODeM
@@ -0,0 +1,392 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#include <core/utils/Convolution.h>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+
+namespace CODeM {
+
+namespace {
+
+typedef complex<double> cdouble;
+
+// Smallest n >= minSize whose only prime factors are 2, 3 and 5. Such a
+// length pads a linear convolution by at most about 1.25x, where a power
+// of two can nearly double it.
+int smoothSize(int minSize)
+{
+    int best = 1;
+    while(best < minSize) {
+        best <<= 1;
+    }
+    for(int p5=1; p5<best; p5*=5) {
+        for(int p35=p5; p35<best; p35*=3) {
+            int n = p35;
+            while(n < minSize) {
+                n <<= 1;
+            }
+            if(n < best) {
+                best = n;
+            }
+        }
+    }
+    return best;
+}
+
+// The power of two that brings the largest |b| to the largest |a|. Two
+// inputs packed into one transform share its round-off, which would swamp
+// the smaller of them, as with an unnormalised pdf against a normalised one.
+double packingScale(const vector<double>& a, const vector<double>& b)
+{
+    double largestA = 0.0;
+    double largestB = 0.0;
+    for(size_t i=0; i<a.size(); i++) {
+        largestA = std::max(largestA, std::abs(a[i]));
+    }
+    for(size_t i=0; i<b.size(); i++) {
+        largestB = std::max(largestB, std::abs(b[i]));
+    }
+    if(!(largestA > 0.0) || !(largestB > 0.0)) {
+        return 1.0;
+    }
+    int expA;
+    int expB;
+    std::frexp(largestA, &expA);
+    std::frexp(largestB, &expB);
+    return std::ldexp(1.0, expA - expB);
+}
+
+// The radices of n, largest first for the powers of two: 4, 2, 3 and 5
+vector<int> radices(int n)
+{
+    vector<int> r;
+    while(n % 4 == 0) {
+        r.push_back(4);
+        n /= 4;
+    }
+    const int nPrimes = 3;
+    const int primes[nPrimes] = {2, 3, 5};
+    for(int f=0; f<nPrimes; f++) {
+        while(n % primes[f] == 0) {
+            r.push_back(primes[f]);
+            n /= primes[f];
+        }
+    }
+    return r;
+}
+
+// a*b without the inf/nan recovery of operator*, which is not inlined
+inline cdouble mul(cdouble a, cdouble b)
+{
+    return cdouble(a.real()*b.real() - a.imag()*b.imag(),
+                   a.real()*b.imag() + a.imag()*b.real());
+}
+
+// -i*a
+inline cdouble mulMinusI(cdouble a)
+{
+    return cdouble(a.imag(), -a.real());
+}
+
+// Forward DFTs of length 2, 3, 4 and 5, in place
+template<int R>
+inline void butterfly(cdouble* v);
+
+template<>
+inline void butterfly<2>(cdouble* v)
+{
+    cdouble t = v[0];
+    v[0] = t + v[1];
+    v[1] = t - v[1];
+}
+
+template<>
+inline void butterfly<3>(cdouble* v)
+{
+    const double s3 = 0.86602540378443864676;
+    cdouble a  = v[1] + v[2];
+    cdouble jb = mulMinusI((v[1] - v[2]) * s3);
+    cdouble d  = v[0] - 0.5*a;
+    v[0] = v[0] + a;
+    v[1] = d + jb;
+    v[2] = d - jb;
+}
+
+template<>
+inline void butterfly<4>(cdouble* v)
+{
+    cdouble a = v[0] + v[2];
+    cdouble b = v[0] - v[2];
+    cdouble d = v[1] + v[3];
+    cdouble e = mulMinusI(v[1] - v[3]);
+    v[0] = a + d;
+    v[1] = b + e;
+    v[2] = a - d;
+    v[3] = b - e;
+}
+
+template<>
+inline void butterfly<5>(cdouble* v)
+{
+    // cos and sin of 2*pi/5 and 4*pi/5
+    const double c1 =  0.30901699437494742410;
+    const double c2 = -0.80901699437494742410;
+    const double s1 =  0.95105651629515357212;
+    const double s2 =  0.58778525229247312917;
+    cdouble a1 = v[1] + v[4];
+    cdouble b1 = v[1] - v[4];
+    cdouble a2 = v[2] + v[3];
+    cdouble b2 = v[2] - v[3];
+    cdouble t1 = v[0] + c1*a1 + c2*a2;
+    cdouble t2 = v[0] + c2*a1 + c1*a2;
+    cdouble u1 = mulMinusI(s1*b1 + s2*b2);
+    cdouble u2 = mulMinusI(s2*b1 - s1*b2);
+    v[0] = v[0] + a1 + a2;
+    v[1] = t1 + u1;
+    v[2] = t2 + u2;
+    v[3] = t2 - u2;
+    v[4] = t1 - u1;
+}
+
+// One Stockham pass of radix R: combines the R transforms of length ns
+// that are interleaved in x into transforms of length ns*R in y. The
+// twiddle of output k, input q is roots[k*q*n/(ns*R)].
+template<int R>
+void fftPass(const cdouble* x, cdouble* y, int n, int ns,
+             const cdouble* roots)
+{
+    int stride = n / R;
+    int step = stride / ns;
+    cdouble v[R];
+    for(int b=0; b<stride; b+=ns) {
+        cdouble* out = y + b*R;
+        for(int k=0; k<ns; k++) {
+            const cdouble* in = x + b + k;
+            v[0] = in[0];
+            for(int q=1; q<R; q++) {
+                v[q] = mul(in[q*stride], roots[k*q*step]);
+            }
+            butterfly<R>(v);
+            for(int q=0; q<R; q++) {
+                out[k + q*ns] = v[q];
+            }
+        }
+    }
+}
+
+// exp(-2*pi*i*m/n) for m = 0..n-1, computed directly to avoid accumulating
+// rounding errors. Every twiddle of a transform of length n is one of them.
+vector<cdouble> rootsOfUnity(int n)
+{
+    const double pi = 3.14159265358979323846;
+    vector<cdouble> roots(n);
+    for(int m=0; m<n; m++) {
+        double ang = -2.0*pi*m/n;
+        roots[m] = cdouble(cos(ang), sin(ang));
+    }
+    return roots;
+}
+
+// Forward mixed-radix Stockham transform of x, whose length must factor
+// into 2, 3 and 5, with the rootsOfUnity() of that length. Each pass
+// combines R transforms of length ns into one of length ns*R, writing into
+// a second buffer, so no bit-reversal is needed. The inverse transform is
+// conj(fft(conj(x)))/n.
+void fft(vector<cdouble>& x, const vector<cdouble>& roots)
+{
+    int n = x.size();
+    vector<cdouble> work(n);
+    vector<int> r = radices(n);
+    int nPasses = r.size();
+    int ns = 1;
+    for(int pass=0; pass<nPasses; pass++) {
+        int R = r[pass];
+        switch(R) {
+        case 2:
+            fftPass<2>(x.data(), work.data(), n, ns, roots.data());
+            break;
+        case 3:
+            fftPass<3>(x.data(), work.data(), n, ns, roots.data());
+            break;
+        case 4:
+            fftPass<4>(x.data(), work.data(), n, ns, roots.data());
+            break;
+        default:
+            fftPass<5>(x.data(), work.data(), n, ns, roots.data());
+            break;
+        }
+        x.swap(work);
+        ns *= R;
+    }
+}
+
+} // namespace
+
+vector<double> convolve(const vector<double>& a, const vector<double>& b)
+{
+    int shorter = (a.size() < b.size()) ? a.size() : b.size();
+    if(shorter < ConvFFTMinNSamples) {
+        return directConvolution(a, b);
+    }
+    return fftConvolution(a, b);
+}
+
+vector<double> convolve(const vector<vector<double> >& inputs)
+{
+    if(inputs.empty()) {
+        return vector<double>();
+    }
+    bool allLong = true;
+    for(size_t i=0; i<inputs.size(); i++) {
+        if((int)inputs[i].size() < ConvFFTMinNSamples) {
+            allLong = false;
+        }
+    }
+    if(allLong && inputs.size() > 1) {
+        return fftConvolution(inputs);
+    }
+
+    vector<double> c = inputs[0];
+    for(size_t i=1; i<inputs.size(); i++) {
+        c = convolve(c, inputs[i]);
+    }
+    return c;
+}
+
+vector<double> directConvolution(const vector<double>& a,
+                                 const vector<double>& b)
+{
+    if(a.empty() || b.empty()) {
+        return vector<double>();
+    }
+    int na = a.size();
+    int nb = b.size();
+    vector<double> c(na+nb-1, 0.0);
+    for(int i=0; i<na; i++) {
+        for(int j=0; j<nb; j++) {
+            c[i+j] += a[i]*b[j];
+        }
+    }
+    return c;
+}
+
+vector<double> fftConvolution(const vector<double>& a,
+                              const vector<double>& b)
+{
+    if(a.empty() || b.empty()) {
+        return vector<double>();
+    }
+    int na = a.size();
+    int nb = b.size();
+    int nc = na + nb - 1;
+    int n = smoothSize(nc);
+
+    // x = a + i*s*b, so a single forward transform gives both spectra
+    double s = packingScale(a, b);
+    vector<cdouble> x(n, cdouble(0.0, 0.0));
+    for(int i=0; i<na; i++) {
+        x[i].real(a[i]);
+    }
+    for(int i=0; i<nb; i++) {
+        x[i].imag(s*b[i]);
+    }
+    vector<cdouble> roots = rootsOfUnity(n);
+    fft(x, roots);
+
+    // A_k = (X_k + conj(X_-k))/2 , B_k = (X_k - conj(X_-k))/2i
+    // and A_k*B_k = (X_k^2 - conj(X_-k)^2)/4i. The inverse transform is
+    // taken as a forward one of the conjugate, whose real part is that of
+    // the result.
+    vector<cdouble> p(n);
+    for(int k=0; k<n; k++) {
+        cdouble xk  = x[k];
+        cdouble xnk = conj(x[(n-k) % n]);
+        p[k] = conj((xk*xk - xnk*xnk) * cdouble(0.0, -0.25));
+    }
+    fft(p, roots);
+
+    vector<double> c(nc);
+    for(int i=0; i<nc; i++) {
+        c[i] = p[i].real() / (n*s);
+    }
+    return c;
+}
+
+vector<double> fftConvolution(const vector<vector<double> >& inputs)
+{
+    if(inputs.empty()) {
+        return vector<double>();
+    }
+    int nc = 1;
+    for(size_t i=0; i<inputs.size(); i++) {
+        if(inputs[i].empty()) {
+            return vector<double>();
+        }
+        nc += inputs[i].size() - 1;
+    }
+    int n = smoothSize(nc);
+    vector<cdouble> roots = rootsOfUnity(n);
+
+    // the product of the spectra, two real inputs per transform as in the
+    // two-input case; a last odd input has a real transform of its own
+    vector<cdouble> p(n, cdouble(1.0, 0.0));
+    vector<cdouble> x(n);
+    double scale = 1.0;
+    for(size_t i=0; i<inputs.size(); i+=2) {
+        const vector<double>& a = inputs[i];
+        bool paired = (i+1 < inputs.size());
+        std::fill(x.begin(), x.end(), cdouble(0.0, 0.0));
+        for(size_t j=0; j<a.size(); j++) {
+            x[j].real(a[j]);
+        }
+        if(paired) {
+            const vector<double>& b = inputs[i+1];
+            double s = packingScale(a, b);
+            for(size_t j=0; j<b.size(); j++) {
+                x[j].imag(s*b[j]);
+            }
+            scale *= s;
+        }
+        fft(x, roots);
+
+        if(paired) {
+            for(int k=0; k<n; k++) {
+                cdouble xk  = x[k];
+                cdouble xnk = conj(x[(n-k) % n]);
+                p[k] = mul(p[k], (xk*xk - xnk*xnk) * cdouble(0.0, -0.25));
+            }
+        } else {
+            for(int k=0; k<n; k++) {
+                p[k] = mul(p[k], x[k]);
+            }
+        }
+    }
+
+    // inverse transform as a forward one of the conjugate
+    for(int k=0; k<n; k++) {
+        p[k] = conj(p[k]);
+    }
+    fft(p, roots);
+
+    vector<double> c(nc);
+    for(int i=0; i<nc; i++) {
+        c[i] = p[i].real() / (n*scale);
+    }
+    return c;
+}
+
+} // namespace CODeM
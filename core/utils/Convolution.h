@@ -0,0 +1,56 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include <vector>
+using namespace std;
+
+namespace CODeM {
+
+// Below this length of the shorter input the direct sum is faster. Measured
+// on equal-length inputs at -O2 (tests/ConvolutionBenchmark): the two are
+// level at 160-192 samples, and the FFT stays ahead from there, since the
+// 2/3/5 transform lengths pad by at most about 1.25x.
+const int ConvFFTMinNSamples = 192;
+
+// Full linear convolution of a and b, of length a.size()+b.size()-1.
+// Dispatches to the direct or the FFT method by input size.
+vector<double> convolve(const vector<double>& a, const vector<double>& b);
+
+// Full linear convolution of all the inputs, of length sum(size)-k+1 for k
+// inputs. When every input is long enough for the FFT, each is transformed
+// once and the spectra are multiplied before a single inverse transform;
+// otherwise the inputs are convolved in turn.
+vector<double> convolve(const vector<vector<double> >& inputs);
+
+// O(n*m) direct summation
+vector<double> directConvolution(const vector<double>& a,
+                                 const vector<double>& b);
+
+// O(N*log(N)) convolution with a mixed-radix (2, 3, 5) FFT, on the
+// smallest such length that holds the result. Both real inputs are packed
+// into a single complex transform.
+vector<double> fftConvolution(const vector<double>& a,
+                              const vector<double>& b);
+
+// The same for k inputs, packed two to a complex transform: (k+1)/2 forward
+// transforms and one inverse
+vector<double> fftConvolution(const vector<vector<double> >& inputs);
+
+} // namespace CODeM
+
+#endif // CONVOLUTION_H
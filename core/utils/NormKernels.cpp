@@ -0,0 +1,61 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#include <core/utils/NormKernels.h>
+
+namespace CODeM {
+
+NormType normType(double p)
+{
+    if(p == 1.0) {
+        return L1Norm;
+    } else if(p == 2.0) {
+        return L2Norm;
+    } else if(std::isinf(p)) {
+        return LInfNorm;
+    } else {
+        return LpNorm;
+    }
+}
+
+double pNorm(const double* vec, int n, NormType type, double p)
+{
+    switch(type) {
+    case L1Norm:
+        return pNorm<L1Norm>(vec, n);
+    case L2Norm:
+        return pNorm<L2Norm>(vec, n);
+    case LInfNorm:
+        return pNorm<LInfNorm>(vec, n);
+    default:
+        return pNorm<LpNorm>(vec, n, p);
+    }
+}
+
+double normalise(double* vec, int n, NormType type, double p)
+{
+    switch(type) {
+    case L1Norm:
+        return normalise<L1Norm>(vec, n);
+    case L2Norm:
+        return normalise<L2Norm>(vec, n);
+    case LInfNorm:
+        return normalise<LInfNorm>(vec, n);
+    default:
+        return normalise<LpNorm>(vec, n, p);
+    }
+}
+
+} // namespace CODeM
@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef NORMKERNELS_H
+#define NORMKERNELS_H
+
+#include <algorithm>
+#include <cmath>
+
+namespace CODeM {
+
+// The p-norms with a specialised kernel. LpNorm is any other p > 0.
+enum NormType {
+    L1Norm,
+    L2Norm,
+    LInfNorm,
+    LpNorm
+};
+
+// The kernel for the p-norm; p = inf selects LInfNorm
+NormType normType(double p);
+
+// A norm is finish(acc, p), where acc is accumulate(acc, |x_i|, p) over the
+// elements of x, starting from 0. p is only read by LpNorm.
+template<NormType T> struct NormKernel;
+
+template<> struct NormKernel<L1Norm>
+{
+    static double accumulate(double acc, double a, double) { return acc + a; }
+    static double finish(double acc, double) { return acc; }
+};
+
+// the square root of a dot product, without the scaling of hypot()
+template<> struct NormKernel<L2Norm>
+{
+    static double accumulate(double acc, double a, double)
+    {
+        return acc + a*a;
+    }
+    static double finish(double acc, double) { return std::sqrt(acc); }
+};
+
+template<> struct NormKernel<LInfNorm>
+{
+    static double accumulate(double acc, double a, double)
+    {
+        return (a > acc) ? a : acc;
+    }
+    static double finish(double acc, double) { return acc; }
+};
+
+// a^p as exp(p*log(a)), which is 0 for a = 0 and p > 0 without a branch.
+// It is cheaper than pow and agrees with it within about |p*log(a)| + 1
+// ulp.
+template<> struct NormKernel<LpNorm>
+{
+    static double accumulate(double acc, double a, double p)
+    {
+        return acc + std::exp(p*std::log(a));
+    }
+    static double finish(double acc, double p)
+    {
+        return std::pow(acc, 1.0/p);
+    }
+};
+
+// Elements per block of pNorm<LpNorm>(); the logs of a block stay on the
+// stack
+const int LpNormBlockSize = 64;
+
+template<NormType T>
+inline double pNorm(const double* vec, int n, double p = 0.0)
+{
+    double acc = 0.0;
+    for(int i=0; i<n; i++) {
+        acc = NormKernel<T>::accumulate(acc, std::abs(vec[i]), p);
+    }
+    return NormKernel<T>::finish(acc, p);
+}
+
+// The log and the exp of NormKernel<LpNorm> in separate loops over blocks,
+// so that each is a plain loop over one libm function. These vectorise
+// where the compiler maps log and exp to a vector math library (glibc's
+// libmvec with -ffast-math); otherwise they stay one call per element.
+// The sum is taken in the order of the elements, as in the generic form.
+template<>
+inline double pNorm<LpNorm>(const double* vec, int n, double p)
+{
+    double logs[LpNormBlockSize];
+    double acc = 0.0;
+    for(int i0=0; i0<n; i0+=LpNormBlockSize) {
+        int nb = std::min(LpNormBlockSize, n - i0);
+        for(int j=0; j<nb; j++) {
+            logs[j] = std::log(std::abs(vec[i0 + j]));
+        }
+        for(int j=0; j<nb; j++) {
+            acc += std::exp(p*logs[j]);
+        }
+    }
+    return NormKernel<LpNorm>::finish(acc, p);
+}
+
+// Scales vec to a unit p-norm and returns its p-norm. A zero vector is
+// left unchanged.
+template<NormType T>
+inline double normalise(double* vec, int n, double p = 0.0)
+{
+    double norm = pNorm<T>(vec, n, p);
+    if(norm > 0.0) {
+        for(int i=0; i<n; i++) {
+            vec[i] /= norm;
+        }
+    }
+    return norm;
+}
+
+// As above, dispatched on type. Callers that evaluate many vectors should
+// resolve the type once with normType() and keep it.
+double pNorm(const double* vec, int n, NormType type, double p = 0.0);
+double normalise(double* vec, int n, NormType type, double p = 0.0);
+
+} // namespace CODeM
+
+#endif // NORMKERNELS_H
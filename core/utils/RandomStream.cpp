@@ -0,0 +1,324 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#include <core/utils/RandomStream.h>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CODEM_PHILOX_AVX2
+#endif
+
+namespace CODeM {
+
+namespace {
+
+const uint32_t PhiloxM0 = 0xD2511F53;
+const uint32_t PhiloxM1 = 0xCD9E8D57;
+const uint32_t PhiloxW0 = 0x9E3779B9;
+const uint32_t PhiloxW1 = 0xBB67AE85;
+
+inline void mulHiLo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo)
+{
+    uint64_t p = (uint64_t)a * (uint64_t)b;
+    hi = (uint32_t)(p >> 32);
+    lo = (uint32_t)p;
+}
+
+const double TwoPow53Inv = 1.0 / 9007199254740992.0;
+const double TwoPi      = 6.283185307179586;
+
+inline double toUniform(uint32_t hi, uint32_t lo)
+{
+    uint64_t x = ((uint64_t)hi << 32) | lo;
+    return (x >> 11) * TwoPow53Inv;
+}
+
+inline void philoxBlock(uint64_t counter, uint64_t streamId, uint64_t seed,
+                        uint32_t* out)
+{
+    // counter = (block index, stream id), key = seed
+    uint32_t c0 = (uint32_t)counter;
+    uint32_t c1 = (uint32_t)(counter >> 32);
+    uint32_t c2 = (uint32_t)streamId;
+    uint32_t c3 = (uint32_t)(streamId >> 32);
+    uint32_t k0 = (uint32_t)seed;
+    uint32_t k1 = (uint32_t)(seed >> 32);
+
+    for(int r=0; r<10; r++) {
+        uint32_t hi0, lo0, hi1, lo1;
+        mulHiLo(PhiloxM0, c0, hi0, lo0);
+        mulHiLo(PhiloxM1, c2, hi1, lo1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PhiloxW0;
+        k1 += PhiloxW1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// Writes nBlocks consecutive blocks, starting at counter, to out
+void philoxBlocksScalar(uint64_t counter, uint64_t streamId, uint64_t seed,
+                        int nBlocks, uint32_t* out)
+{
+    for(int b=0; b<nBlocks; b++) {
+        philoxBlock(counter + b, streamId, seed, out + 4*b);
+    }
+}
+
+#ifdef CODEM_PHILOX_AVX2
+__attribute__((target("avx2")))
+inline void mulHiLo8(__m256i m, __m256i c, __m256i& hi, __m256i& lo)
+{
+    __m256i even = _mm256_mul_epu32(m, c);
+    __m256i odd  = _mm256_mul_epu32(m, _mm256_srli_epi64(c, 32));
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Eight blocks per iteration, one per lane
+__attribute__((target("avx2")))
+void philoxBlocksAVX2(uint64_t counter, uint64_t streamId, uint64_t seed,
+                      int nBlocks, uint32_t* out)
+{
+    const __m256i m0 = _mm256_set1_epi32((int)PhiloxM0);
+    const __m256i m1 = _mm256_set1_epi32((int)PhiloxM1);
+    int b = 0;
+    for(; b+8<=nBlocks; b+=8) {
+        uint32_t lo[8], hi[8];
+        for(int l=0; l<8; l++) {
+            lo[l] = (uint32_t)(counter + b + l);
+            hi[l] = (uint32_t)((counter + b + l) >> 32);
+        }
+        __m256i c0 = _mm256_loadu_si256((const __m256i*)lo);
+        __m256i c1 = _mm256_loadu_si256((const __m256i*)hi);
+        __m256i c2 = _mm256_set1_epi32((int)(uint32_t)streamId);
+        __m256i c3 = _mm256_set1_epi32((int)(uint32_t)(streamId >> 32));
+        uint32_t k0 = (uint32_t)seed;
+        uint32_t k1 = (uint32_t)(seed >> 32);
+
+        for(int r=0; r<10; r++) {
+            __m256i hi0, lo0, hi1, lo1;
+            mulHiLo8(m0, c0, hi0, lo0);
+            mulHiLo8(m1, c2, hi1, lo1);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1),
+                                  _mm256_set1_epi32((int)k0));
+            c1 = lo1;
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3),
+                                  _mm256_set1_epi32((int)k1));
+            c3 = lo0;
+            k0 += PhiloxW0;
+            k1 += PhiloxW1;
+        }
+
+        // transpose the four words of the eight lanes into block order
+        uint32_t w[4][8];
+        _mm256_storeu_si256((__m256i*)w[0], c0);
+        _mm256_storeu_si256((__m256i*)w[1], c1);
+        _mm256_storeu_si256((__m256i*)w[2], c2);
+        _mm256_storeu_si256((__m256i*)w[3], c3);
+        for(int l=0; l<8; l++) {
+            for(int j=0; j<4; j++) {
+                out[4*(b+l)+j] = w[j][l];
+            }
+        }
+    }
+    philoxBlocksScalar(counter + b, streamId, seed, nBlocks - b, out + 4*b);
+}
+#endif
+
+typedef void (*PhiloxBlocksFunction)(uint64_t, uint64_t, uint64_t,
+                                     int, uint32_t*);
+
+PhiloxBlocksFunction selectPhiloxBlocks()
+{
+#ifdef CODEM_PHILOX_AVX2
+    if(__builtin_cpu_supports("avx2")) {
+        return philoxBlocksAVX2;
+    }
+#endif
+    return philoxBlocksScalar;
+}
+
+std::atomic<PhiloxBlocksFunction> philoxBlocks(selectPhiloxBlocks());
+
+std::atomic<uint64_t> defaultSeed(0);
+std::atomic<uint64_t> nextThreadStream(0);
+
+thread_local RandomStream* installedStream = 0;
+
+} // namespace
+
+RandomStream::RandomStream(uint64_t seed, uint64_t streamId)
+{
+    defineStream(seed, streamId);
+}
+
+void RandomStream::defineStream(uint64_t seed, uint64_t streamId)
+{
+    m_seed     = seed;
+    m_streamId = streamId;
+    skipTo(0);
+}
+
+uint64_t RandomStream::seed() const
+{
+    return m_seed;
+}
+
+uint64_t RandomStream::streamId() const
+{
+    return m_streamId;
+}
+
+void RandomStream::skipTo(uint64_t block)
+{
+    m_counter   = block;
+    m_blockPos  = 4;
+    m_bufferPos = RandomStreamBufferSize;
+}
+
+uint32_t RandomStream::randUInt32()
+{
+    if(m_blockPos == 4) {
+        generateBlock();
+    }
+    return m_block[m_blockPos++];
+}
+
+uint64_t RandomStream::randUInt64()
+{
+    uint64_t hi = randUInt32();
+    uint64_t lo = randUInt32();
+    return (hi << 32) | lo;
+}
+
+void RandomStream::refillBuffer()
+{
+    generateUniform(m_buffer, RandomStreamBufferSize);
+    m_bufferPos = 0;
+}
+
+double RandomStream::randUni(double range, double offset)
+{
+    return offset + range * randUni();
+}
+
+void RandomStream::fillUniform(double* out, int n)
+{
+    int nBuffered = std::min(n, RandomStreamBufferSize - m_bufferPos);
+    std::copy(m_buffer + m_bufferPos, m_buffer + m_bufferPos + nBuffered, out);
+    m_bufferPos += nBuffered;
+    generateUniform(out + nBuffered, n - nBuffered);
+}
+
+void RandomStream::fillNormal(double* out, int n, double mean, double std)
+{
+    fillUniform(out, n);
+    for(int i=0; i+1<n; i+=2) {
+        // 1-u is in (0,1]
+        double r = std::sqrt(-2.0 * std::log(1.0 - out[i]));
+        double theta = TwoPi * out[i+1];
+        out[i]   = mean + std * r * std::cos(theta);
+        out[i+1] = mean + std * r * std::sin(theta);
+    }
+    if(n % 2 == 1) {
+        double r = std::sqrt(-2.0 * std::log(1.0 - out[n-1]));
+        out[n-1] = mean + std * r * std::cos(TwoPi * randUni());
+    }
+}
+
+void RandomStream::generateBlock()
+{
+    philoxBlock(m_counter, m_streamId, m_seed, m_block);
+    m_blockPos = 0;
+    m_counter++;
+}
+
+void RandomStream::generateUniform(double* out, int n)
+{
+    int i = 0;
+    // finish the current block first, so that the sequence matches
+    // consecutive calls to randUInt64()
+    for(; i<n && m_blockPos < 4; i++) {
+        out[i] = (randUInt64() >> 11) * TwoPow53Inv;
+    }
+
+    const int chunk = 128;
+    uint32_t words[4*chunk];
+    while(n - i >= 2) {
+        int nBlocks = std::min(chunk, (n - i) / 2);
+        philoxBlocks.load(std::memory_order_relaxed)(m_counter, m_streamId,
+                                                     m_seed, nBlocks, words);
+        m_counter += nBlocks;
+        for(int b=0; b<nBlocks; b++) {
+            out[i++] = toUniform(words[4*b],   words[4*b+1]);
+            out[i++] = toUniform(words[4*b+2], words[4*b+3]);
+        }
+    }
+
+    if(i < n) {
+        out[i] = (randUInt64() >> 11) * TwoPow53Inv;
+    }
+}
+
+RandomStream* currentRandomStream()
+{
+    if(installedStream != 0) {
+        return installedStream;
+    }
+    thread_local RandomStream threadStream(defaultSeed.load(),
+                                           nextThreadStream++);
+    return &threadStream;
+}
+
+bool defineVectorGeneration(bool enabled)
+{
+    PhiloxBlocksFunction f = enabled ? selectPhiloxBlocks()
+                                     : philoxBlocksScalar;
+    philoxBlocks = f;
+    return f != philoxBlocksScalar;
+}
+
+void defineDefaultRandomSeed(uint64_t seed)
+{
+    defaultSeed = seed;
+}
+
+uint64_t defaultRandomSeed()
+{
+    return defaultSeed.load();
+}
+
+ScopedRandomStream::ScopedRandomStream(RandomStream* stream)
+{
+    m_previous = installedStream;
+    installedStream = stream;
+}
+
+ScopedRandomStream::~ScopedRandomStream()
+{
+    installedStream = m_previous;
+}
+
+} // namespace CODeM
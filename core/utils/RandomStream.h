@@ -0,0 +1,113 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <cstdint>
+
+namespace CODeM {
+
+// Number of uniforms generated at a time for randUni()
+const int RandomStreamBufferSize = 512;
+
+// A stream of random numbers from the counter-based Philox4x32-10
+// generator. The n-th output of a stream is a pure function of
+// (seed, streamId, n), so independent streams can be handed to threads or
+// tasks and results do not depend on how the work is scheduled.
+//
+// Blocks are generated in bulk, eight at a time with AVX2 when the CPU
+// supports it, and randUni() consumes a buffer of such uniforms. The
+// vector and scalar paths produce identical numbers.
+class RandomStream
+{
+public:
+    explicit RandomStream(uint64_t seed = 0, uint64_t streamId = 0);
+
+    void     defineStream(uint64_t seed, uint64_t streamId);
+    uint64_t seed()     const;
+    uint64_t streamId() const;
+
+    // Moves to the n-th 128-bit block of the stream
+    void     skipTo(uint64_t block);
+
+    // raw words, taken from the generator after any buffered uniforms
+    uint32_t randUInt32();
+    uint64_t randUInt64();
+    // uniform in [0,1)
+    double   randUni();
+    // uniform in [offset, offset+range)
+    double   randUni(double range, double offset = 0.0);
+
+    // n uniforms in [0,1), the same numbers as n calls to randUni()
+    void     fillUniform(double* out, int n);
+    // n normal variates (Box-Muller)
+    void     fillNormal(double* out, int n, double mean = 0.0,
+                        double std = 1.0);
+
+private:
+    void generateBlock();
+    void refillBuffer();
+    // uniforms taken directly from the generator, bypassing m_buffer
+    void generateUniform(double* out, int n);
+
+    uint64_t m_seed;
+    uint64_t m_streamId;
+    uint64_t m_counter;
+    uint32_t m_block[4];
+    int      m_blockPos;
+    double   m_buffer[RandomStreamBufferSize];
+    int      m_bufferPos;
+};
+
+inline double RandomStream::randUni()
+{
+    if(m_bufferPos == RandomStreamBufferSize) {
+        refillBuffer();
+    }
+    return m_buffer[m_bufferPos++];
+}
+
+// The stream used by the sampling functions on the calling thread. Unless
+// one is installed with ScopedRandomStream, each thread gets its own
+// stream derived from defaultRandomSeed() and the order of first use.
+// That order depends on scheduling, so draws made on more than one thread
+// are only reproducible from run to run when every thread installs a
+// stream of its own, as evaluatePopulation() does for each individual.
+// A single-threaded program always gets stream 0.
+RandomStream* currentRandomStream();
+
+// Bulk generation uses AVX2 when enabled (the default) and supported by the
+// CPU. Returns whether the vector path is now in use. Both paths produce
+// the same numbers; the switch is meant for benchmarks and tests.
+bool     defineVectorGeneration(bool enabled);
+
+void     defineDefaultRandomSeed(uint64_t seed);
+uint64_t defaultRandomSeed();
+
+// Installs a stream as the current stream of this thread for its lifetime
+class ScopedRandomStream
+{
+public:
+    explicit ScopedRandomStream(RandomStream* stream);
+    ~ScopedRandomStream();
+
+private:
+    RandomStream* m_previous;
+};
+
+} // namespace CODeM
+
+#endif // RANDOMSTREAM_H
@@ -0,0 +1,59 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <vector>
+#include <type_traits>
+using namespace std;
+
+namespace CODeM {
+
+// A non-owning view of size() contiguous elements. The viewed memory must
+// outlive the span.
+template<typename T>
+class Span
+{
+public:
+    typedef typename remove_const<T>::type value_type;
+
+    Span() : m_data(0), m_size(0) {}
+    Span(T* data, int size) : m_data(data), m_size(size) {}
+    Span(vector<value_type>& vec)
+        : m_data(vec.data()), m_size(static_cast<int>(vec.size())) {}
+    template<typename U = T,
+             typename enable_if<is_const<U>::value, int>::type = 0>
+    Span(const vector<value_type>& vec)
+        : m_data(vec.data()), m_size(static_cast<int>(vec.size())) {}
+
+    T*   data()             const { return m_data;         }
+    int  size()             const { return m_size;         }
+    bool isEmpty()          const { return m_size == 0;    }
+    T&   operator[](int i)  const { return m_data[i];      }
+    T*   begin()            const { return m_data;         }
+    T*   end()              const { return m_data + m_size; }
+
+private:
+    T*  m_data;
+    int m_size;
+};
+
+typedef Span<const double> ConstDoubleSpan;
+typedef Span<double>       DoubleSpan;
+
+} // namespace CODeM
+
+#endif // SPAN_H
@@ -0,0 +1,168 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#include <core/utils/ThreadPool.h>
+#include <algorithm>
+
+namespace CODeM {
+
+ThreadPool::ThreadPool(int nThreads)
+    : m_task(0),
+      m_generation(0),
+      m_nBusy(0),
+      m_stop(false)
+{
+    if(nThreads <= 0) {
+        nThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    for(int w=0; w<nThreads; w++) {
+        m_queues.push_back(new WorkQueue);
+    }
+    // worker 0 is the thread calling parallelFor
+    for(int w=1; w<nThreads; w++) {
+        m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, w));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    int nSpawned = m_threads.size();
+    for(int i=0; i<nSpawned; i++) {
+        m_threads[i].join();
+    }
+    int nWorkers = m_queues.size();
+    for(int w=0; w<nWorkers; w++) {
+        delete m_queues[w];
+    }
+}
+
+int ThreadPool::nThreads() const
+{
+    return m_queues.size();
+}
+
+void ThreadPool::parallelFor(int n, const std::function<void(int, int)>& task,
+                             int grainSize)
+{
+    if(n <= 0) {
+        return;
+    }
+    grainSize = std::max(1, grainSize);
+
+    std::lock_guard<std::mutex> run(m_runMutex);
+    m_task = &task;
+
+    // contiguous blocks of chunks per worker, so that without stealing
+    // each thread walks through neighbouring individuals
+    int nChunks = (n + grainSize - 1) / grainSize;
+    int nWorkers = nThreads();
+    for(int w=0; w<nWorkers; w++) {
+        int cBegin = (long long)nChunks * w / nWorkers;
+        int cEnd   = (long long)nChunks * (w+1) / nWorkers;
+        std::lock_guard<std::mutex> lock(m_queues[w]->mutex);
+        for(int c=cBegin; c<cEnd; c++) {
+            m_queues[w]->ranges.push_back(
+                        std::make_pair(c*grainSize,
+                                       std::min(n, (c+1)*grainSize)));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+        m_nBusy++;
+    }
+    m_wake.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_nBusy--;
+    m_done.wait(lock, [this]{ return m_nBusy == 0; });
+    m_task = 0;
+}
+
+ThreadPool* ThreadPool::globalInstance()
+{
+    static ThreadPool pool;
+    return &pool;
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+    unsigned long seen = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]{ return m_stop || m_generation != seen; });
+            if(m_stop) {
+                return;
+            }
+            seen = m_generation;
+            m_nBusy++;
+        }
+
+        runTasks(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(--m_nBusy == 0) {
+            m_done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::runTasks(int worker)
+{
+    // no range is queued once every queue is empty, so a failed
+    // takeRange() means this worker is done
+    std::pair<int,int> range;
+    while(takeRange(worker, range)) {
+        for(int i=range.first; i<range.second; i++) {
+            (*m_task)(i, worker);
+        }
+    }
+}
+
+bool ThreadPool::takeRange(int worker, std::pair<int,int>& range)
+{
+    {
+        WorkQueue* own = m_queues[worker];
+        std::lock_guard<std::mutex> lock(own->mutex);
+        if(!own->ranges.empty()) {
+            range = own->ranges.back();
+            own->ranges.pop_back();
+            return true;
+        }
+    }
+
+    int nWorkers = nThreads();
+    for(int i=1; i<nWorkers; i++) {
+        WorkQueue* victim = m_queues[(worker + i) % nWorkers];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if(!victim->ranges.empty()) {
+            range = victim->ranges.front();
+            victim->ranges.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace CODeM
@@ -0,0 +1,76 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+namespace CODeM {
+
+// A fixed set of worker threads for data-parallel loops. Each worker owns
+// a deque of index ranges: it takes work from the back of its own deque and,
+// when that is empty, steals from the front of the others. The calling
+// thread takes part as worker 0.
+class ThreadPool
+{
+public:
+    // nThreads <= 0 uses one thread per hardware core
+    explicit ThreadPool(int nThreads = 0);
+    ~ThreadPool();
+
+    int nThreads() const;
+
+    // Calls task(i, worker) for every i in [0,n) and returns when all calls
+    // are done. worker is in [0,nThreads()) and identifies the thread, so
+    // it can index per-thread scratch data. Indices are handed out in
+    // chunks of grainSize. Not reentrant: task must not call parallelFor.
+    void parallelFor(int n, const std::function<void(int, int)>& task,
+                     int grainSize = 1);
+
+    // A pool shared by the library, created on first use
+    static ThreadPool* globalInstance();
+
+private:
+    struct WorkQueue {
+        std::mutex                     mutex;
+        std::deque<std::pair<int,int> > ranges;
+    };
+
+    void workerLoop(int worker);
+    void runTasks(int worker);
+    bool takeRange(int worker, std::pair<int,int>& range);
+
+    std::vector<std::thread>                 m_threads;
+    std::vector<WorkQueue*>                  m_queues;
+    const std::function<void(int, int)>*     m_task;
+    std::mutex                               m_mutex;
+    std::mutex                               m_runMutex;
+    std::condition_variable                  m_wake;
+    std::condition_variable                  m_done;
+    unsigned long                            m_generation;
+    int                                      m_nBusy;
+    bool                                     m_stop;
+};
+
+} // namespace CODeM
+
+#endif // THREADPOOL_H
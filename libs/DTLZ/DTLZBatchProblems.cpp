@@ -0,0 +1,399 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+
+#include <libs/DTLZ/DTLZBatchProblems.h>
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace DTLZ {
+namespace Batch {
+
+namespace {
+
+const double Pi         = 3.14159265358979323846;
+const double TwoOverPi  = 6.36619772367581382433e-01;
+// 1.5*2^52: adding and subtracting it rounds to the nearest integer
+const double RoundMagic = 6755399441055744.0;
+// pi/2 split in three parts of 33 bits, so that q*part is exact for the
+// quadrant numbers q of the supported range
+const double PiO2_1     = 1.57079632673412561417e+00;
+const double PiO2_2     = 6.07710050630396597660e-11;
+const double PiO2_3     = 2.02226624871116645580e-21;
+// minimax polynomials of sin and cos on [-pi/4, pi/4] (fdlibm)
+const double S1 = -1.66666666666666324348e-01;
+const double S2 =  8.33333333332248946124e-03;
+const double S3 = -1.98412698298579493134e-04;
+const double S4 =  2.75573137070700676789e-06;
+const double S5 = -2.50507602534068634195e-08;
+const double S6 =  1.58969099521155010221e-10;
+const double C1 =  4.16666666666666019037e-02;
+const double C2 = -1.38888888888741095749e-03;
+const double C3 =  2.48015872894767294178e-05;
+const double C4 = -2.75573143513906633035e-07;
+const double C5 =  2.08757232129817482790e-09;
+const double C6 = -1.13596475577881948265e-11;
+
+const int DTLZ4Alpha = 100;
+
+// Branch-free, so that the loops calling it vectorise
+inline void sinCosKernel(double a, double& s, double& c)
+{
+    double q = (a * TwoOverPi + RoundMagic) - RoundMagic;
+    int quadrant = static_cast<int>(q);
+    double r = a - q * PiO2_1;
+    r = r - q * PiO2_2;
+    r = r - q * PiO2_3;
+
+    double z = r * r;
+    double sr = r + r * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5
+                                                             + z * S6)))));
+    double cr = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4
+                                                        + z * (C5 + z * C6)))));
+
+    bool swap = (quadrant & 1) != 0;
+    double sv = swap ? cr : sr;
+    double cv = swap ? sr : cr;
+    s = (quadrant & 2)       ? -sv : sv;
+    c = ((quadrant + 1) & 2) ? -cv : cv;
+}
+
+void sinArray(const double* a, int N, double* s)
+{
+    double c;
+    for(int j=0; j<N; j++) {
+        sinCosKernel(a[j], s[j], c);
+    }
+}
+
+void cosArray(const double* a, int N, double* c)
+{
+    double s;
+    for(int j=0; j<N; j++) {
+        sinCosKernel(a[j], s, c[j]);
+    }
+}
+
+// x^e by repeated squaring, with sq as scratch; e is the same for all the
+// elements, so the loop has no data-dependent branches
+void powArray(const double* x, int N, int e, double* out, double* sq)
+{
+    for(int j=0; j<N; j++) {
+        out[j] = 1.0;
+    }
+    const double* base = x;
+    while(e > 0) {
+        if(e & 1) {
+            for(int j=0; j<N; j++) {
+                out[j] *= base[j];
+            }
+        }
+        e >>= 1;
+        if(e > 0) {
+            for(int j=0; j<N; j++) {
+                sq[j] = base[j] * base[j];
+            }
+            base = sq;
+        }
+    }
+}
+
+struct Scratch
+{
+    Scratch(double* workspace, int N)
+        : g(workspace), p(g + N), a(p + N), s(a + N), c(s + N)
+    {
+    }
+
+    double* g;
+    double* p;
+    double* a;
+    double* s;
+    double* c;
+};
+
+double* scratchMemory(double* workspace, std::vector<double>& allocated,
+                      int N)
+{
+    if(workspace != 0) {
+        return workspace;
+    }
+    allocated.resize(workspaceSize(N));
+    return allocated.data();
+}
+
+bool argsOK(const double* x, int n, int N, int M, const double* f)
+{
+    return x != 0 && f != 0 && N > 0 && M >= 2 && n >= M;
+}
+
+// 1 + g of DTLZ2, DTLZ4 and DTLZ5
+void gSphere(const double* x, int n, int N, int M, double* g)
+{
+    for(int j=0; j<N; j++) {
+        g[j] = 0.0;
+    }
+    for(int i=M-1; i<n; i++) {
+        const double* xi = x + i*N;
+        for(int j=0; j<N; j++) {
+            double t = xi[j] - 0.5;
+            g[j] += t * t;
+        }
+    }
+    for(int j=0; j<N; j++) {
+        g[j] = 1.0 + g[j];
+    }
+}
+
+// 1 + g of DTLZ1 and DTLZ3
+void gRastrigin(const double* x, int n, int N, int M, const Scratch& s)
+{
+    const double w = 20.0 * Pi;
+    int k = n - M + 1;
+    for(int j=0; j<N; j++) {
+        s.g[j] = 0.0;
+    }
+    for(int i=M-1; i<n; i++) {
+        const double* xi = x + i*N;
+        for(int j=0; j<N; j++) {
+            s.a[j] = w * (xi[j] - 0.5);
+        }
+        cosArray(s.a, N, s.c);
+        for(int j=0; j<N; j++) {
+            double t = xi[j] - 0.5;
+            s.g[j] += t * t - s.c[j];
+        }
+    }
+    for(int j=0; j<N; j++) {
+        s.g[j] = 1.0 + (static_cast<double>(k) + s.g[j]);
+    }
+}
+
+// 1 + g of DTLZ6
+void gPower(const double* x, int n, int N, int M, double* g)
+{
+    for(int j=0; j<N; j++) {
+        g[j] = 0.0;
+    }
+    for(int i=M-1; i<n; i++) {
+        const double* xi = x + i*N;
+        for(int j=0; j<N; j++) {
+            g[j] += std::pow(xi[j], 0.1);
+        }
+    }
+    for(int j=0; j<N; j++) {
+        g[j] = 1.0 + g[j];
+    }
+}
+
+enum AngleType {
+    PlainAngle,     // DTLZ2, DTLZ3
+    PowerAngle,     // DTLZ4
+    DegenerateAngle // DTLZ5, DTLZ6
+};
+
+// The spherical front of DTLZ2-DTLZ6, with s.g holding 1 + g. The product
+// of the cosines of the first m angles is kept in s.p and extended by one
+// factor per objective.
+template<AngleType T>
+void sphericalFront(const double* x, int N, int M, double* f,
+                    const Scratch& s)
+{
+    for(int j=0; j<N; j++) {
+        s.p[j] = 1.0;
+    }
+    for(int m=0; m<M-1; m++) {
+        const double* xm = x + m*N;
+        if(T == PowerAngle) {
+            powArray(xm, N, DTLZ4Alpha, s.a, s.c);
+            for(int j=0; j<N; j++) {
+                s.a[j] = s.a[j] * Pi / 2.0;
+            }
+        } else if(T == DegenerateAngle && m > 0) {
+            for(int j=0; j<N; j++) {
+                double g = s.g[j] - 1.0;
+                s.a[j] = Pi / (4.0 * s.g[j]) * (1.0 + 2.0 * g * xm[j]);
+            }
+        } else {
+            for(int j=0; j<N; j++) {
+                s.a[j] = xm[j] * Pi / 2.0;
+            }
+        }
+        sinCos(s.a, N, s.s, s.c);
+
+        double* fm = f + (M-1-m)*N;
+        for(int j=0; j<N; j++) {
+            fm[j] = s.g[j] * s.p[j] * s.s[j];
+            s.p[j] *= s.c[j];
+        }
+    }
+    for(int j=0; j<N; j++) {
+        f[j] = s.g[j] * s.p[j];
+    }
+}
+
+} // namespace
+
+int workspaceSize(int N)
+{
+    return 5*N;
+}
+
+void sinCos(const double* a, int N, double* s, double* c)
+{
+    if(s == 0 && c == 0) {
+        return;
+    }
+    if(c == 0) {
+        sinArray(a, N, s);
+    } else if(s == 0) {
+        cosArray(a, N, c);
+    } else {
+        for(int j=0; j<N; j++) {
+            sinCosKernel(a[j], s[j], c[j]);
+        }
+    }
+}
+
+void DTLZ1(const double* x, int n, int N, int M, double* f,
+           double* workspace)
+{
+    assert(argsOK(x, n, N, M, f));
+    std::vector<double> allocated;
+    const Scratch s(scratchMemory(workspace, allocated, N), N);
+
+    gRastrigin(x, n, N, M, s);
+
+    // Linear front: s.p holds 0.5*(1+g) times the product of the first m
+    // variables
+    for(int j=0; j<N; j++) {
+        s.p[j] = s.g[j] * 0.5;
+    }
+    for(int m=0; m<M-1; m++) {
+        const double* xm = x + m*N;
+        double* fm = f + (M-1-m)*N;
+        for(int j=0; j<N; j++) {
+            fm[j] = s.p[j] * (1 - xm[j]);
+            s.p[j] *= xm[j];
+        }
+    }
+    for(int j=0; j<N; j++) {
+        f[j] = s.p[j];
+    }
+}
+
+void DTLZ2(const double* x, int n, int N, int M, double* f,
+           double* workspace)
+{
+    assert(argsOK(x, n, N, M, f));
+    std::vector<double> allocated;
+    const Scratch s(scratchMemory(workspace, allocated, N), N);
+
+    gSphere(x, n, N, M, s.g);
+    sphericalFront<PlainAngle>(x, N, M, f, s);
+}
+
+void DTLZ3(const double* x, int n, int N, int M, double* f,
+           double* workspace)
+{
+    assert(argsOK(x, n, N, M, f));
+    std::vector<double> allocated;
+    const Scratch s(scratchMemory(workspace, allocated, N), N);
+
+    gRastrigin(x, n, N, M, s);
+    sphericalFront<PlainAngle>(x, N, M, f, s);
+}
+
+void DTLZ4(const double* x, int n, int N, int M, double* f,
+           double* workspace)
+{
+    assert(argsOK(x, n, N, M, f));
+    std::vector<double> allocated;
+    const Scratch s(scratchMemory(workspace, allocated, N), N);
+
+    gSphere(x, n, N, M, s.g);
+    sphericalFront<PowerAngle>(x, N, M, f, s);
+}
+
+void DTLZ5(const double* x, int n, int N, int M, double* f,
+           double* workspace)
+{
+    assert(argsOK(x, n, N, M, f));
+    std::vector<double> allocated;
+    const Scratch s(scratchMemory(workspace, allocated, N), N);
+
+    gSphere(x, n, N, M, s.g);
+    sphericalFront<DegenerateAngle>(x, N, M, f, s);
+}
+
+void DTLZ6(const double* x, int n, int N, int M, double* f,
+           double* workspace)
+{
+    assert(argsOK(x, n, N, M, f));
+    std::vector<double> allocated;
+    const Scratch s(scratchMemory(workspace, allocated, N), N);
+
+    gPower(x, n, N, M, s.g);
+    sphericalFront<DegenerateAngle>(x, N, M, f, s);
+}
+
+void DTLZ7(const double* x, int n, int N, int M, double* f,
+           double* workspace)
+{
+    assert(argsOK(x, n, N, M, f));
+    std::vector<double> allocated;
+    const Scratch s(scratchMemory(workspace, allocated, N), N);
+    int k = n - M + 1;
+
+    // 1 + g
+    for(int j=0; j<N; j++) {
+        s.g[j] = 0.0;
+    }
+    for(int i=M-1; i<n; i++) {
+        const double* xi = x + i*N;
+        for(int j=0; j<N; j++) {
+            s.g[j] += xi[j];
+        }
+    }
+    for(int j=0; j<N; j++) {
+        s.g[j] = 2.0 + 9.0 * s.g[j] / k;
+    }
+
+    // h, accumulated in s.p
+    for(int j=0; j<N; j++) {
+        s.p[j] = static_cast<double>(M);
+    }
+    for(int m=0; m<M-1; m++) {
+        const double* xm = x + m*N;
+        double* fm = f + m*N;
+        for(int j=0; j<N; j++) {
+            fm[j] = xm[j];
+            s.a[j] = 3.0 * Pi * xm[j];
+        }
+        sinArray(s.a, N, s.s);
+        for(int j=0; j<N; j++) {
+            s.p[j] -= xm[j] / s.g[j] * (1.0 + s.s[j]);
+        }
+    }
+    double* fLast = f + (M-1)*N;
+    for(int j=0; j<N; j++) {
+        fLast[j] = s.g[j] * s.p[j];
+    }
+}
+
+} // namespace Batch
+} // namespace DTLZ
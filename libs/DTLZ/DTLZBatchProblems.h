@@ -0,0 +1,70 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+#ifndef DTLZBATCHPROBLEMS_H
+#define DTLZBATCHPROBLEMS_H
+
+namespace DTLZ {
+namespace Batch {
+
+// Batch versions of the DTLZ problems, evaluating N decision vectors at
+// once. The data is held in structure-of-arrays form: variable i of
+// individual j is x[i*N + j], and objective m of individual j is written
+// to f[m*N + j]. With N = 1, x and f are plain decision and objective
+// vectors.
+//
+// n is the number of decision variables and M the number of objectives;
+// the last k = n - M + 1 variables are the distance variables. As in
+// DTLZProblems.cpp, the g function of DTLZ1 and DTLZ3 omits the scaling
+// by 100 of the DTLZ paper.
+//
+// All the loops run over the individuals, so they vectorise. sin and cos
+// are evaluated by the polynomial kernels below instead of libm, and the
+// products of cosines are built as prefix products that are shared by all
+// the objectives.
+//
+// Intermediate values are kept in workspace, which must hold
+// workspaceSize(N) doubles. If workspace is 0, one is allocated for the
+// call. As in the WFG batch engine, the arguments are checked with assert:
+// x and f not 0, N > 0, M >= 2 and n >= M.
+
+int workspaceSize(int N);
+
+void DTLZ1(const double* x, int n, int N, int M, double* f,
+           double* workspace = 0);
+void DTLZ2(const double* x, int n, int N, int M, double* f,
+           double* workspace = 0);
+void DTLZ3(const double* x, int n, int N, int M, double* f,
+           double* workspace = 0);
+// alpha = 100
+void DTLZ4(const double* x, int n, int N, int M, double* f,
+           double* workspace = 0);
+void DTLZ5(const double* x, int n, int N, int M, double* f,
+           double* workspace = 0);
+void DTLZ6(const double* x, int n, int N, int M, double* f,
+           double* workspace = 0);
+void DTLZ7(const double* x, int n, int N, int M, double* f,
+           double* workspace = 0);
+
+// sin(a[j]) and cos(a[j]) for j in [0,N). For |a| < 1e6 the results are
+// within 2 ulp of libm, except close to the zeros of sin and cos, where
+// the absolute error stays below 1e-25. Either output may be 0 if it is
+// not needed.
+void sinCos(const double* a, int N, double* s, double* c);
+
+} // namespace Batch
+} // namespace DTLZ
+
+#endif // DTLZBATCHPROBLEMS_H
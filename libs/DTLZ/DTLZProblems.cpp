@@ -14,9 +14,13 @@
 **
 ****************************************************************************/
 
-#include <tigon/Representation/Functions/DTLZ/DTLZProblems.h>
+#include <libs/DTLZ/DTLZProblems.h>
 
-#include <QtMath>
+#include <boost/math/constants/constants.hpp>
+#include <cmath>
+
+using namespace std;
+using boost::math::constants::pi;
 
 namespace DTLZ {
 
@@ -26,7 +30,7 @@ vector<double > DTLZ1(const vector<double >& x, const int M)
     int k = n - M + 1;
     double g = 0.0;
     for (int i = n - k; i < n; i++) {
-        g += (x[i] - 0.5)*(x[i] - 0.5) - qCos(20.0 * pi<double>() * (x[i] - 0.5));
+        g += (x[i] - 0.5)*(x[i] - 0.5) - cos(20.0 * pi<double>() * (x[i] - 0.5));
     }
     // This is the DTLZ paper version, but the huge scaling has no added value
 //    g = 100.0 * ((double)k + g);
@@ -63,9 +67,9 @@ vector<double > DTLZ2(const vector<double >& x, const int M)
     for (j=(M-1); j >= 0; j--) {
         coss = 1.0;
         for (i=0; i<M-j-1; i++) {
-            coss *= qCos(x[i]*pi<double>()/2.0) ;
+            coss *= cos(x[i]*pi<double>()/2.0) ;
         }
-        sine = (j>0) ? ((j==M-1) ? qSin(x[M-j-1]*pi<double>()/2.0) : qSin(x[i]*pi<double>()/2.0)) : 1.0;
+        sine = (j>0) ? ((j==M-1) ? sin(x[M-j-1]*pi<double>()/2.0) : sin(x[i]*pi<double>()/2.0)) : 1.0;
         y[j] = (1.0+g) * coss * sine;
     }
 
@@ -21,9 +21,9 @@
 
 namespace DTLZ {
 
-//vector<double > DTLZ1(const vector<double >& x, const int M);
-vector<double > DTLZ1(const vector<double >& x, const int M);
-vector<double > DTLZ2(const vector<double >& x, const int M);
+//std::vector<double > DTLZ1(const std::vector<double >& x, const int M);
+std::vector<double > DTLZ1(const std::vector<double >& x, const int M);
+std::vector<double > DTLZ2(const std::vector<double >& x, const int M);
 
 }  // namespace DTLZ
 
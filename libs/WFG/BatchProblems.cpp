@@ -0,0 +1,924 @@
+/*
+ * Copyright (C) 2005 The Walking Fish Group (WFG).
+ *
+ * This material is provided "as is", with no warranty expressed or implied.
+ * Any use is at your own risk. Permission to use or copy this software for
+ * any purpose is hereby granted without fee, provided this notice is
+ * retained on all copies. Permission to modify the code and to distribute
+ * modified code is granted, provided a notice that the code was modified is
+ * included with the above copyright notice.
+ *
+ * http://www.wfg.csse.uwa.edu.au/
+ */
+
+
+/*
+ * BatchProblems.cpp
+ *
+ * Implementation of BatchProblems.h.
+ *
+ * The shape functions below, and the kernels of InlineTransFunctions.h,
+ * repeat the expressions of ShapeFunctions.cpp and TransFunctions.cpp term
+ * by term; any change to those must be mirrored here to keep the two
+ * bit-identical. The argument checks are made once per problem rather than
+ * once per value.
+ */
+
+
+#include "BatchProblems.h"
+
+
+//// Standard includes. /////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+
+//// Toolkit includes. //////////////////////////////////////////////////////
+
+#include "Misc.h"
+#include "InlineTransFunctions.h"
+
+
+//// Used namespaces. ///////////////////////////////////////////////////////
+
+using namespace WFGT::Toolkit;
+using namespace WFGT::Toolkit::Examples;
+using namespace WFGT::Toolkit::InlineTransFunctions;
+using std::vector;
+
+
+//// Local functions. ///////////////////////////////////////////////////////
+
+namespace
+{
+
+//** True if "k" in [1,n), "M" >= 2, and "k" mod ("M"-1) == 0. **************
+bool ArgsOK( const int n, const int k, const int M )
+{
+  return k >= 1 && k < n && M >= 2 && k % ( M-1 ) == 0;
+}
+
+
+//// Batch transformations. /////////////////////////////////////////////////
+
+/*
+ * "y" points to the first of "len" consecutive arrays of "N" values, and
+ * results are written to arrays of "N" values.
+ */
+
+//** r_sum of each individual, with weights "w". ****************************
+void r_sum
+(
+  const double* y,
+  const double* w,
+  const int len,
+  const int N,
+  double* t
+)
+{
+  double denominator = 0.0;
+
+  for( int j = 0; j < N; j++ )
+  {
+    t[j] = 0.0;
+  }
+
+  for( int i = 0; i < len; i++ )
+  {
+    const double* y_i = y + i*N;
+    const double  w_i = w[i];
+
+    for( int j = 0; j < N; j++ )
+    {
+      t[j] += w_i*y_i[j];
+    }
+
+    denominator += w_i;
+  }
+
+  for( int j = 0; j < N; j++ )
+  {
+    t[j] = correct_to_01( t[j] / denominator );
+  }
+}
+
+//** r_nonsep of each individual. "sorted" is scratch for 2*len values. *****
+void r_nonsep
+(
+  const double* y,
+  const int len,
+  const int A,
+  const int N,
+  double* sorted,
+  double* t
+)
+{
+  if( A == len && len >= r_nonsep_sort_size )
+  {
+    // gather each individual for the sorted form of the numerator
+    for( int j = 0; j < N; j++ )
+    {
+      for( int i = 0; i < len; i++ )
+      {
+        sorted[len+i] = y[i*N+j];
+      }
+
+      t[j] = r_nonsep_numerator( sorted + len, len, A, sorted );
+    }
+  }
+  else
+  {
+    for( int j = 0; j < N; j++ )
+    {
+      t[j] = 0.0;
+    }
+
+    for( int i = 0; i < len; i++ )
+    {
+      const double* y_i = y + i*N;
+
+      for( int j = 0; j < N; j++ )
+      {
+        t[j] += y_i[j];
+      }
+
+      for( int l = 0; l <= A-2; l++ )
+      {
+        const double* y_l = y + ( ( i+l+1 ) % len )*N;
+
+        for( int j = 0; j < N; j++ )
+        {
+          t[j] += fabs( y_i[j] - y_l[j] );
+        }
+      }
+    }
+  }
+
+  const double tmp = ceil( A/2.0 );
+  const double denominator = len*tmp*( 1.0 + 2.0*A - 2.0*tmp )/A;
+
+  for( int j = 0; j < N; j++ )
+  {
+    t[j] = correct_to_01( t[j] / denominator );
+  }
+}
+
+//** b_param_following of each individual, with running sums in "sum". *****
+void b_param_following
+(
+  double* y,
+  const int n,
+  const int first,
+  const int last,
+  const int N,
+  double* sum
+)
+{
+  std::fill( sum, sum + N, 0.0 );
+
+  for( int i = n-1; i >= first; i-- )
+  {
+    double* y_i = y + i*N;
+
+    for( int j = 0; j < N; j++ )
+    {
+      const double y_ij = y_i[j];
+
+      if( i < last )
+      {
+        y_i[j] = wfg_b_param( y_ij, sum[j], n-1-i );
+      }
+
+      sum[j] += y_ij;
+    }
+  }
+}
+
+//** b_param_preceding of each individual, with running sums in "sum". *****
+void b_param_preceding
+(
+  double* y,
+  const int first,
+  const int last,
+  const int N,
+  double* sum
+)
+{
+  std::fill( sum, sum + N, 0.0 );
+
+  for( int i = 0; i < last; i++ )
+  {
+    double* y_i = y + i*N;
+
+    for( int j = 0; j < N; j++ )
+    {
+      const double y_ij = y_i[j];
+
+      if( i >= first )
+      {
+        y_i[j] = wfg_b_param( y_ij, sum[j], i );
+      }
+
+      sum[j] += y_ij;
+    }
+  }
+}
+
+//** Reduces each paramer to the domain [0,1]. ******************************
+void WFG_normalise_z( const double* z, const int n, const int N, double* y )
+{
+  for( int i = 0; i < n; i++ )
+  {
+    const double bound = 2.0*( i+1 );
+
+    for( int j = 0; j < N; j++ )
+    {
+      assert( z[i*N+j] >= 0.0   );
+      assert( z[i*N+j] <= bound );
+
+      y[i*N+j] = z[i*N+j] / bound;
+    }
+  }
+}
+
+//** WFG1_t1, in place. *****************************************************
+void WFG1_t1( double* y, const int n, const int k, const int N )
+{
+  for( int i = k*N; i < n*N; i++ )
+  {
+    y[i] = s_linear( y[i], 0.35 );
+  }
+}
+
+//** WFG1_t2, in place. *****************************************************
+void WFG1_t2( double* y, const int n, const int k, const int N )
+{
+  for( int i = k*N; i < n*N; i++ )
+  {
+    y[i] = b_flat( y[i], 0.8, 0.75, 0.85 );
+  }
+}
+
+//** WFG1_t3, in place. *****************************************************
+void WFG1_t3( double* y, const int n, const int N )
+{
+  for( int i = 0; i < n*N; i++ )
+  {
+    y[i] = b_poly( y[i], 0.02 );
+  }
+}
+
+//** WFG1_t4 and WFG2_t3 (with unit weights) into the M arrays of "t". ******
+void WFG1_t4
+(
+  const double* y,
+  const int n,
+  const int k,
+  const int M,
+  const int N,
+  const bool unit_weights,
+  double* w,
+  double* t
+)
+{
+  for( int i = 1; i <= n; i++ )
+  {
+    w[i-1] = unit_weights ? 1.0 : 2.0*i;
+  }
+
+  for( int i = 1; i <= M-1; i++ )
+  {
+    const int head = ( i-1 )*k/( M-1 );
+    const int tail = i*k/( M-1 );
+
+    r_sum( y + head*N, &w[head], tail-head, N, t + ( i-1 )*N );
+  }
+
+  r_sum( y + k*N, &w[k], n-k, N, t + ( M-1 )*N );
+}
+
+//** WFG2_t2 into the k+(n-k)/2 arrays of "t". ******************************
+void WFG2_t2( const double* y, const int n, const int k, const int N, double* t )
+{
+  const int l = n-k;
+
+  std::copy( y, y + k*N, t );
+
+  for( int i = k+1; i <= k+l/2; i++ )
+  {
+    const int head = k+2*( i-k )-2;
+
+    r_nonsep( y + head*N, 2, 2, N, 0, t + ( i-1 )*N );
+  }
+}
+
+//** WFG4_t1, in place. *****************************************************
+void WFG4_t1( double* y, const int n, const int N )
+{
+  for( int i = 0; i < n*N; i++ )
+  {
+    y[i] = s_multi( y[i], 30, 10, 0.35 );
+  }
+}
+
+//** WFG5_t1, in place. *****************************************************
+void WFG5_t1( double* y, const int n, const int N )
+{
+  for( int i = 0; i < n*N; i++ )
+  {
+    y[i] = s_decept( y[i], 0.35, 0.001, 0.05 );
+  }
+}
+
+//** WFG6_t2 into the M arrays of "t", using "sorted" as for r_nonsep. ******
+void WFG6_t2
+(
+  const double* y,
+  const int n,
+  const int k,
+  const int M,
+  const int N,
+  double* sorted,
+  double* t
+)
+{
+  for( int i = 1; i <= M-1; i++ )
+  {
+    const int head = ( i-1 )*k/( M-1 );
+    const int tail = i*k/( M-1 );
+
+    r_nonsep( y + head*N, tail-head, k/( M-1 ), N, sorted, t + ( i-1 )*N );
+  }
+
+  r_nonsep( y + k*N, n-k, n-k, N, sorted, t + ( M-1 )*N );
+}
+
+//** WFG7_t1, in place. *****************************************************
+void WFG7_t1( double* y, const int n, const int k, const int N, double* u )
+{
+  b_param_following( y, n, 0, k, N, u );
+}
+
+//** WFG8_t1, in place. *****************************************************
+void WFG8_t1( double* y, const int n, const int k, const int N, double* u )
+{
+  b_param_preceding( y, k, n, N, u );
+}
+
+//** WFG9_t1, in place. *****************************************************
+void WFG9_t1( double* y, const int n, const int N, double* u )
+{
+  b_param_following( y, n, 0, n-1, N, u );
+}
+
+//** WFG9_t2, in place. *****************************************************
+void WFG9_t2( double* y, const int n, const int k, const int N )
+{
+  for( int i = 0; i < k*N; i++ )
+  {
+    y[i] = s_decept( y[i], 0.35, 0.001, 0.05 );
+  }
+
+  for( int i = k*N; i < n*N; i++ )
+  {
+    y[i] = s_multi( y[i], 30, 95, 0.35 );
+  }
+}
+
+//** I3_t1, in place. *******************************************************
+void I3_t1( double* y, const int n, const int N, double* u )
+{
+  b_param_preceding( y, 1, n, N, u );
+}
+
+
+//// Batch shapes, as in ShapeFunctions.cpp and ExampleShapes.cpp. //////////
+
+enum ShapeType { WFG1Shape, WFG2Shape, WFG3Shape, WFG4Shape, I1Shape };
+
+//** linear, convex or concave of each individual for m = 1..M, into the ****
+//** M arrays of "h", as ShapeFunctions' whole-front functions. The      ****
+//** prefix product is kept in the array of h_1.                         ****
+void shape_front
+(
+  const ShapeType type,
+  const double* x,
+  const int M,
+  const int N,
+  double* h
+)
+{
+  for( int j = 0; j < N; j++ )
+  {
+    h[j] = 1.0;
+  }
+
+  for( int i = 0; i < M-1; i++ )
+  {
+    const double* x_i = x + i*N;
+    double*       h_m = h + ( M-i-1 )*N;
+
+    for( int j = 0; j < N; j++ )
+    {
+      switch( type )
+      {
+      case WFG3Shape:
+        h_m[j] = correct_to_01( h[j]*( 1 - x_i[j] ) );
+        h[j] *= x_i[j];
+        break;
+      case WFG1Shape: case WFG2Shape:
+        h_m[j] = correct_to_01( h[j]*( 1.0 - sin( x_i[j]*Misc::PI/2.0 ) ) );
+        h[j] *= 1.0 - cos( x_i[j]*Misc::PI/2.0 );
+        break;
+      default:
+        h_m[j] = correct_to_01( h[j]*cos( x_i[j]*Misc::PI/2.0 ) );
+        h[j] *= sin( x_i[j]*Misc::PI/2.0 );
+        break;
+      }
+    }
+  }
+
+  for( int j = 0; j < N; j++ )
+  {
+    h[j] = correct_to_01( h[j] );
+  }
+}
+
+//** The shape of each individual from the M arrays of "t_p", into "f". *****
+//** "x" is scratch space for M arrays.                                 *****
+void WFG_shape
+(
+  const ShapeType type,
+  const double* t_p,
+  const int M,
+  const int N,
+  double* x,
+  double* f
+)
+{
+  const double* t_back = t_p + ( M-1 )*N;
+
+  for( int i = 0; i < M-1; i++ )
+  {
+    const short A = ( type != WFG3Shape || i == 0 ) ? 1 : 0;
+
+    for( int j = 0; j < N; j++ )
+    {
+      const double tmp1 = std::max< double >( t_back[j], A );
+
+      x[i*N+j] = tmp1*( t_p[i*N+j] - 0.5 ) + 0.5;
+    }
+  }
+
+  std::copy( t_back, t_back + N, x + ( M-1 )*N );
+
+  shape_front( type, x, M, N, f );
+
+  for( int m = 1; m <= M; m++ )
+  {
+    double* h = f + ( m-1 )*N;
+
+    if( m == M && type == WFG1Shape )
+    {
+      const int    A     = 5;
+      const double alpha = 1.0;
+      const double tmp   = 2.0*A*Misc::PI;
+
+      for( int j = 0; j < N; j++ )
+      {
+        h[j] = correct_to_01( pow( 1.0-x[j]-cos( tmp*x[j] + Misc::PI/2.0 )/tmp, alpha ) );
+      }
+    }
+    else if( m == M && type == WFG2Shape )
+    {
+      const int    A     = 5;
+      const double alpha = 1.0;
+      const double beta  = 1.0;
+
+      for( int j = 0; j < N; j++ )
+      {
+        const double tmp1 = A*pow( x[j], beta )*Misc::PI;
+
+        h[j] = correct_to_01( 1.0 - pow( x[j], alpha )*pow( cos( tmp1 ), 2.0 ) );
+      }
+    }
+
+    const double  D      = 1.0;
+    const double  S      = type == I1Shape ? 1.0 : m*2.0;
+    const double* x_back = x + ( M-1 )*N;
+
+    for( int j = 0; j < N; j++ )
+    {
+      h[j] = D*x_back[j] + S*h[j];
+    }
+  }
+}
+
+
+//// Workspace. /////////////////////////////////////////////////////////////
+
+//** The arrays of a workspace of BatchProblems::workspace_size() doubles. **
+struct Scratch
+{
+  Scratch( double* workspace, const int n, const int N, const int M )
+    : y( workspace ),
+      t( y + n*N ),
+      u( t + n*N ),
+      x( u + N ),
+      w( x + M*N ),
+      sorted( w + n )
+  {
+  }
+
+  double* y;
+  double* t;
+  double* u;
+  double* x;
+  double* w;
+  double* sorted;
+};
+
+//** "workspace", or "allocated" resized to hold a workspace if it is 0. ****
+double* scratch_memory
+(
+  double* workspace,
+  vector< double >& allocated,
+  const int n,
+  const int N,
+  const int M
+)
+{
+  if( workspace != 0 )
+  {
+    return workspace;
+  }
+
+  allocated.resize( BatchProblems::workspace_size( n, N, M ) );
+
+  return &allocated[0];
+}
+
+}  // unnamed namespace
+
+
+//// Implemented functions. /////////////////////////////////////////////////
+
+int BatchProblems::workspace_size( const int n, const int N, const int M )
+{
+  return ( 2*n + M + 1 )*N + 3*n;
+}
+
+void BatchProblems::WFG1
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG1_t1( s.y, n, k, N );
+  WFG1_t2( s.y, n, k, N );
+  WFG1_t3( s.y, n, N );
+  WFG1_t4( s.y, n, k, M, N, false, s.w, s.t );
+
+  WFG_shape( WFG1Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::WFG2
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+  assert( ( n-k ) % 2 == 0 );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  const int n2 = k + ( n-k )/2;
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG1_t1( s.y, n, k, N );
+  WFG2_t2( s.y, n, k, N, s.t );
+  WFG1_t4( s.t, n2, k, M, N, true, s.w, s.y );
+
+  WFG_shape( WFG2Shape, s.y, M, N, s.x, f );
+}
+
+void BatchProblems::WFG3
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+  assert( ( n-k ) % 2 == 0 );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  const int n2 = k + ( n-k )/2;
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG1_t1( s.y, n, k, N );
+  WFG2_t2( s.y, n, k, N, s.t );
+  WFG1_t4( s.t, n2, k, M, N, true, s.w, s.y );
+
+  WFG_shape( WFG3Shape, s.y, M, N, s.x, f );
+}
+
+void BatchProblems::WFG4
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG4_t1( s.y, n, N );
+  WFG1_t4( s.y, n, k, M, N, true, s.w, s.t );
+
+  WFG_shape( WFG4Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::WFG5
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG5_t1( s.y, n, N );
+  WFG1_t4( s.y, n, k, M, N, true, s.w, s.t );
+
+  WFG_shape( WFG4Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::WFG6
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG1_t1( s.y, n, k, N );
+  WFG6_t2( s.y, n, k, M, N, s.sorted, s.t );
+
+  WFG_shape( WFG4Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::WFG7
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG7_t1( s.y, n, k, N, s.u );
+  WFG1_t1( s.y, n, k, N );
+  WFG1_t4( s.y, n, k, M, N, true, s.w, s.t );
+
+  WFG_shape( WFG4Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::WFG8
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG8_t1( s.y, n, k, N, s.u );
+  WFG1_t1( s.y, n, k, N );
+  WFG1_t4( s.y, n, k, M, N, true, s.w, s.t );
+
+  WFG_shape( WFG4Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::WFG9
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  WFG_normalise_z( z, n, N, s.y );
+
+  WFG9_t1( s.y, n, N, s.u );
+  WFG9_t2( s.y, n, k, N );
+  WFG6_t2( s.y, n, k, M, N, s.sorted, s.t );
+
+  WFG_shape( WFG4Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::I1
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  std::copy( z, z + n*N, s.y );
+
+  WFG1_t1( s.y, n, k, N );
+  WFG1_t4( s.y, n, k, M, N, true, s.w, s.t );
+
+  WFG_shape( I1Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::I2
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  std::copy( z, z + n*N, s.y );
+
+  WFG9_t1( s.y, n, N, s.u );
+  WFG1_t1( s.y, n, k, N );
+  WFG1_t4( s.y, n, k, M, N, true, s.w, s.t );
+
+  WFG_shape( I1Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::I3
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  std::copy( z, z + n*N, s.y );
+
+  I3_t1( s.y, n, N, s.u );
+  WFG1_t1( s.y, n, k, N );
+  WFG1_t4( s.y, n, k, M, N, true, s.w, s.t );
+
+  WFG_shape( I1Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::I4
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  std::copy( z, z + n*N, s.y );
+
+  WFG1_t1( s.y, n, k, N );
+  WFG6_t2( s.y, n, k, M, N, s.sorted, s.t );
+
+  WFG_shape( I1Shape, s.t, M, N, s.x, f );
+}
+
+void BatchProblems::I5
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace
+)
+{
+  assert( ArgsOK( n, k, M ) );
+
+  vector< double > allocated;
+  const Scratch s( scratch_memory( workspace, allocated, n, N, M ), n, N, M );
+
+  std::copy( z, z + n*N, s.y );
+
+  I3_t1( s.y, n, N, s.u );
+  WFG1_t1( s.y, n, k, N );
+  WFG6_t2( s.y, n, k, M, N, s.sorted, s.t );
+
+  WFG_shape( I1Shape, s.t, M, N, s.x, f );
+}
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2005 The Walking Fish Group (WFG).
+ *
+ * This material is provided "as is", with no warranty expressed or implied.
+ * Any use is at your own risk. Permission to use or copy this software for
+ * any purpose is hereby granted without fee, provided this notice is
+ * retained on all copies. Permission to modify the code and to distribute
+ * modified code is granted, provided a notice that the code was modified is
+ * included with the above copyright notice.
+ *
+ * http://www.wfg.csse.uwa.edu.au/
+ */
+
+
+/*
+ * BatchProblems.h
+ *
+ * Batch versions of the problems in ExampleProblems.h, evaluating "N"
+ * decision vectors at once. Data is held in structure-of-arrays form: "z"
+ * stores variable i of individual j at z[i*N + j], and objective m of
+ * individual j is written to f[m*N + j]. Every transition works on whole
+ * arrays, so the loops over the individuals vectorise, and the arithmetic
+ * is performed in the same order as in the scalar functions, so the
+ * results are bit-identical to those of ExampleProblems.h (when compiling
+ * for FMA-capable targets, this requires -ffp-contract=off, otherwise the
+ * compiler may fuse the two versions differently). The exceptions are
+ * r_nonsep of r_nonsep_sort_size values or more, whose sorted form agrees
+ * only up to rounding, and the b_param transitions of WFG7, WFG9 and I2,
+ * whose running sums of the following values do as well (see
+ * InlineTransFunctions.h).
+ *
+ * Modified: added to the toolkit as a batch evaluation engine.
+ */
+
+
+#ifndef BATCH_PROBLEMS_H
+#define BATCH_PROBLEMS_H
+
+
+//// Definitions/namespaces. ////////////////////////////////////////////////
+
+namespace WFGT
+{
+
+namespace Toolkit
+{
+
+namespace Examples
+{
+
+namespace BatchProblems
+{
+
+/*
+ * For all problems, "n" is the number of decision variables, the first "k"
+ * of which are the position-related parameters, "M" is the number of
+ * objectives, "z" holds n*N values and "f" receives M*N values.
+ *
+ * All intermediate values are kept in "workspace", which must hold
+ * workspace_size( n, N, M ) doubles. Every stage writes into it in place,
+ * so with a caller-owned workspace an evaluation makes no heap
+ * allocations; if "workspace" is 0 one is allocated for the call. With
+ * N = 1, "z" and "f" are plain decision and objective vectors, which gives
+ * an allocation-free version of the scalar problems.
+ */
+
+//** Number of doubles of workspace needed to evaluate N vectors. ***********
+int workspace_size( const int n, const int N, const int M );
+
+//** The WFG1 problem. ******************************************************
+void WFG1
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG2 problem. ******************************************************
+void WFG2
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG3 problem. ******************************************************
+void WFG3
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG4 problem. ******************************************************
+void WFG4
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG5 problem. ******************************************************
+void WFG5
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG6 problem. ******************************************************
+void WFG6
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG7 problem. ******************************************************
+void WFG7
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG8 problem. ******************************************************
+void WFG8
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The WFG9 problem. ******************************************************
+void WFG9
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The I1 problem. ********************************************************
+void I1
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The I2 problem. ********************************************************
+void I2
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The I3 problem. ********************************************************
+void I3
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The I4 problem. ********************************************************
+void I4
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+//** The I5 problem. ********************************************************
+void I5
+(
+  const double* z,
+  const int n,
+  const int N,
+  const int k,
+  const int M,
+  double* f,
+  double* workspace = 0
+);
+
+}  // BatchProblems namespace
+
+}  // Examples namespace
+
+}  // Toolkit namespace
+
+}  // WFG namespace
+
+#endif
@@ -0,0 +1,750 @@
+/*
+ * Copyright (C) 2005 The Walking Fish Group (WFG).
+ *
+ * This material is provided "as is", with no warranty expressed or implied.
+ * Any use is at your own risk. Permission to use or copy this software for
+ * any purpose is hereby granted without fee, provided this notice is
+ * retained on all copies. Permission to modify the code and to distribute
+ * modified code is granted, provided a notice that the code was modified is
+ * included with the above copyright notice.
+ *
+ * http://www.wfg.csse.uwa.edu.au/
+ */
+
+
+/*
+ * ComposedProblems.h
+ *
+ * WFG problems declared as types. A problem is a pipeline of transition
+ * stages followed by a shape, for example
+ *
+ *   typedef WFGProblem< Normalise,
+ *                       SLinear< 35, 100, DistanceParams >,
+ *                       RSum< UnitWeights >,
+ *                       ConcaveShape<> > MyProblem;
+ *
+ *   std::vector< double > f = MyProblem::evaluate( z, k, M );
+ *
+ * The real-valued parameters of a stage are given as integer ratios, so
+ * that they are compile-time constants: they are checked with
+ * static_assert, and the stages are inlined into a single function per
+ * problem. The stages use the kernels of InlineTransFunctions.h, so the
+ * composed versions of WFG1--WFG9 and I1--I5 at the end of this file
+ * give the same results as those of ExampleProblems.h, up to the rounding
+ * of the sorted r_nonsep of large groups and of the running sums of the
+ * b_param transitions of WFG7, WFG9 and I2.
+ *
+ * Modified: added to the toolkit for defining custom problems.
+ */
+
+
+#ifndef COMPOSED_PROBLEMS_H
+#define COMPOSED_PROBLEMS_H
+
+
+//// Standard includes. /////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+
+//// Toolkit includes. //////////////////////////////////////////////////////
+
+#include "Misc.h"
+#include "InlineTransFunctions.h"
+
+
+//// Definitions/namespaces. ////////////////////////////////////////////////
+
+namespace WFGT
+{
+
+namespace Toolkit
+{
+
+namespace Composed
+{
+
+/*
+ * A transition stage is a type with a static function
+ *
+ *   apply( double* y, int& n, const int k, const int M, double* tmp )
+ *
+ * that transforms the "n" values of "y" in place. Reductions also update
+ * "n". "tmp" is scratch space for 2n values. A shape is a type with a
+ * static function
+ *
+ *   apply( const double* t_p, const int M, double* x, double* f )
+ *
+ * that maps the "M" values of "t_p" to the "M" objectives "f", using "x"
+ * as scratch space for "M" values.
+ */
+
+
+//// Parameter ranges. //////////////////////////////////////////////////////
+
+//** The parameters an element-wise transition is applied to. ***************
+enum Params { AllParams, PositionParams, DistanceParams };
+
+//** The first and one-past-last indices of the parameters "P". *************
+template< Params P >
+inline void param_range( const int n, const int k, int& first, int& last )
+{
+  first = P == DistanceParams ? k : 0;
+  last  = P == PositionParams ? k : n;
+}
+
+
+//// Transitions. ///////////////////////////////////////////////////////////
+
+//** Reduces each parameter to [0,1], with the WFG bounds 2, 4, 6, ... ******
+struct Normalise
+{
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int, const int, double* )
+  {
+    for( int i = 0; i < n; i++ )
+    {
+      const double bound = 2.0*( i+1 );
+
+      assert( y[i] >= 0.0   );
+      assert( y[i] <= bound );
+
+      y[i] = y[i] / bound;
+    }
+  }
+};
+
+//** s_linear with A = AN/AD. ***********************************************
+template< int AN, int AD, Params P = AllParams >
+struct SLinear
+{
+  static_assert( AN > 0 && AN < AD, "s_linear requires 0 < A < 1" );
+
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    const double A = double( AN )/AD;
+
+    int first, last;
+    param_range< P >( n, k, first, last );
+
+    for( int i = first; i < last; i++ )
+    {
+      y[i] = InlineTransFunctions::s_linear( y[i], A );
+    }
+  }
+};
+
+//** b_flat with A = AN/D, B = BN/D and C = CN/D. ***************************
+template< int AN, int BN, int CN, int D, Params P = AllParams >
+struct BFlat
+{
+  static_assert( AN >= 0 && AN <= D, "b_flat requires 0 <= A <= 1" );
+  static_assert( BN >= 0 && BN < CN && CN <= D, "b_flat requires 0 <= B < C <= 1" );
+  static_assert( BN != 0 || ( AN == 0 && CN != D ), "b_flat: invalid B = 0" );
+  static_assert( CN != D || ( AN == D && BN != 0 ), "b_flat: invalid C = 1" );
+
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    const double A = double( AN )/D;
+    const double B = double( BN )/D;
+    const double C = double( CN )/D;
+
+    int first, last;
+    param_range< P >( n, k, first, last );
+
+    for( int i = first; i < last; i++ )
+    {
+      y[i] = InlineTransFunctions::b_flat( y[i], A, B, C );
+    }
+  }
+};
+
+//** b_poly with alpha = AN/AD. *********************************************
+template< int AN, int AD, Params P = AllParams >
+struct BPoly
+{
+  static_assert( AN > 0 && AN != AD, "b_poly requires alpha > 0, alpha != 1" );
+
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    const double alpha = double( AN )/AD;
+
+    int first, last;
+    param_range< P >( n, k, first, last );
+
+    for( int i = first; i < last; i++ )
+    {
+      y[i] = InlineTransFunctions::b_poly( y[i], alpha );
+    }
+  }
+};
+
+//** s_decept with A = AN/D, B = BN/D and C = CN/D. *************************
+template< int AN, int BN, int CN, int D, Params P = AllParams >
+struct SDecept
+{
+  static_assert( AN > 0 && BN > 0 && CN > 0 && CN < D, "s_decept: A, B, C in (0,1)" );
+  static_assert( AN - BN > 0 && AN + BN < D, "s_decept requires A-B > 0 and A+B < 1" );
+
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    const double A = double( AN )/D;
+    const double B = double( BN )/D;
+    const double C = double( CN )/D;
+
+    int first, last;
+    param_range< P >( n, k, first, last );
+
+    for( int i = first; i < last; i++ )
+    {
+      y[i] = InlineTransFunctions::s_decept( y[i], A, B, C );
+    }
+  }
+};
+
+//** s_multi with A minima, B = BN/D and C = CN/D. **************************
+template< int A, int BN, int CN, int D, Params P = AllParams >
+struct SMulti
+{
+  static_assert( A >= 1 && BN >= 0, "s_multi requires A >= 1 and B >= 0" );
+  static_assert( CN > 0 && CN < D, "s_multi requires 0 < C < 1" );
+  // ( 4A+2 )*pi >= 4B, with pi > 3.14159
+  static_assert( ( 4LL*A+2 )*314159LL*D >= 4LL*BN*100000LL,
+                 "s_multi requires ( 4A+2 )pi >= 4B" );
+
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    const double B = double( BN )/D;
+    const double C = double( CN )/D;
+
+    int first, last;
+    param_range< P >( n, k, first, last );
+
+    for( int i = first; i < last; i++ )
+    {
+      y[i] = InlineTransFunctions::s_multi( y[i], A, B, C );
+    }
+  }
+};
+
+/*
+ * b_param of each parameter, with "u" the mean of the parameters that
+ * follow it (as in WFG7 and WFG9) or that precede it (as in WFG8 and I3).
+ * Parameters without any following (preceding) parameters are unchanged.
+ */
+
+//** b_param depending on the mean of the following parameters. *************
+template< Params P = AllParams >
+struct BParamFollowing
+{
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    int first, last;
+    param_range< P >( n, k, first, last );
+
+    InlineTransFunctions::b_param_following( y, n, first, std::min( last, n-1 ) );
+  }
+};
+
+//** b_param depending on the mean of the preceding parameters. *************
+template< Params P = AllParams >
+struct BParamPreceding
+{
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    int first, last;
+    param_range< P >( n, k, first, last );
+
+    InlineTransFunctions::b_param_preceding( y, std::max( first, 1 ), last );
+  }
+};
+
+
+//// Reductions. ////////////////////////////////////////////////////////////
+
+//** Weights 1, 1, 1, ... ***************************************************
+struct UnitWeights
+{
+  static double weight( const int ) { return 1.0; }
+};
+
+//** Weights 2, 4, 6, ... ***************************************************
+struct LinearWeights
+{
+  static double weight( const int i ) { return 2.0*( i+1 ); }
+};
+
+//** r_sum of y[head], ..., y[tail-1]. **************************************
+template< typename W >
+inline double r_sum( const double* y, const int head, const int tail )
+{
+  double numerator   = 0.0;
+  double denominator = 0.0;
+
+  for( int i = head; i < tail; i++ )
+  {
+    numerator   += W::weight( i )*y[i];
+    denominator += W::weight( i );
+  }
+
+  return InlineTransFunctions::correct_to_01( numerator / denominator );
+}
+
+//** r_nonsep of the "len" values from "y". *********************************
+inline double r_nonsep
+(
+  const double* y,
+  const int len,
+  const int A,
+  double* sorted
+)
+{
+  const double numerator =
+    InlineTransFunctions::r_nonsep_numerator( y, len, A, sorted );
+
+  const double tmp = std::ceil( A/2.0 );
+  const double denominator = len*tmp*( 1.0 + 2.0*A - 2.0*tmp )/A;
+
+  return InlineTransFunctions::correct_to_01( numerator / denominator );
+}
+
+//** Weighted sums of the M-1 position groups and of the distance params. ***
+template< typename W = UnitWeights >
+struct RSum
+{
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int M, double* tmp )
+  {
+    for( int i = 1; i <= M-1; i++ )
+    {
+      tmp[i-1] = r_sum< W >( y, ( i-1 )*k/( M-1 ), i*k/( M-1 ) );
+    }
+
+    tmp[M-1] = r_sum< W >( y, k, n );
+
+    std::copy( tmp, tmp + M, y );
+    n = M;
+  }
+};
+
+//** r_nonsep of the M-1 position groups and of the distance parameters. ****
+struct RNonsep
+{
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int M, double* tmp )
+  {
+    for( int i = 1; i <= M-1; i++ )
+    {
+      const int head = ( i-1 )*k/( M-1 );
+      const int tail = i*k/( M-1 );
+
+      tmp[i-1] = r_nonsep( y + head, tail-head, k/( M-1 ), tmp + M );
+    }
+
+    tmp[M-1] = r_nonsep( y + k, n-k, n-k, tmp + M );
+
+    std::copy( tmp, tmp + M, y );
+    n = M;
+  }
+};
+
+//** r_nonsep of consecutive pairs of distance parameters. ******************
+struct RNonsepPairs
+{
+  static const bool is_shape = false;
+
+  static void apply( double* y, int& n, const int k, const int, double* )
+  {
+    const int l = n-k;
+
+    assert( l % 2 == 0 );
+
+    // ascending, so that pair p is read before y[k+p] is replaced
+    for( int p = 0; p < l/2; p++ )
+    {
+      y[k+p] = r_nonsep( y + k+2*p, 2, 2, 0 );
+    }
+
+    n = k + l/2;
+  }
+};
+
+
+//// Shapes. ////////////////////////////////////////////////////////////////
+
+//** Scaling of the objectives: S_m = 2m (WFG) or S_m = 1 (I1). *************
+enum ShapeScaling { WFGScaling, UnitScaling };
+
+//** f_m = x_M + S_m*h_m, with the values h_m already in "f". ***************
+template< ShapeScaling S >
+inline void shape_f( const double* x, const int M, double* f )
+{
+  for( int m = 1; m <= M; m++ )
+  {
+    const double S_m = S == UnitScaling ? 1.0 : m*2.0;
+
+    f[m-1] = 1.0*x[M-1] + S_m*f[m-1];
+  }
+}
+
+//** calculate_x, with A = 1,0,0,... if "degenerate", 1,1,1,... otherwise. **
+inline void shape_x
+(
+  const double* t_p,
+  const int M,
+  const bool degenerate,
+  double* x
+)
+{
+  for( int i = 0; i < M-1; i++ )
+  {
+    const short  A    = ( !degenerate || i == 0 ) ? 1 : 0;
+    const double tmp1 = std::max< double >( t_p[M-1], A );
+
+    x[i] = tmp1*( t_p[i] - 0.5 ) + 0.5;
+  }
+
+  x[M-1] = t_p[M-1];
+}
+
+//** The linear, convex or concave shape function for m = 1..M, into ********
+//** "f", with the prefix product kept in f[0].                      ********
+enum ShapeFunction { LinearFunction, ConvexFunction, ConcaveFunction };
+
+template< ShapeFunction H >
+inline void shape_h( const double* x, const int M, double* f )
+{
+  f[0] = 1.0;
+
+  for( int i = 0; i < M-1; i++ )
+  {
+    switch( H )
+    {
+    case LinearFunction:
+      f[M-i-1] = InlineTransFunctions::correct_to_01( f[0]*( 1 - x[i] ) );
+      f[0] *= x[i];
+      break;
+    case ConvexFunction:
+      f[M-i-1] = InlineTransFunctions::correct_to_01(
+            f[0]*( 1.0 - std::sin( x[i]*Misc::PI/2.0 ) ) );
+      f[0] *= 1.0 - std::cos( x[i]*Misc::PI/2.0 );
+      break;
+    default:
+      f[M-i-1] = InlineTransFunctions::correct_to_01(
+            f[0]*std::cos( x[i]*Misc::PI/2.0 ) );
+      f[0] *= std::sin( x[i]*Misc::PI/2.0 );
+      break;
+    }
+  }
+
+  f[0] = InlineTransFunctions::correct_to_01( f[0] );
+}
+
+//** Concave front (WFG4--WFG9 and, unscaled, I1). **************************
+template< ShapeScaling S = WFGScaling >
+struct ConcaveShape
+{
+  static const bool is_shape = true;
+
+  static void apply( const double* t_p, const int M, double* x, double* f )
+  {
+    shape_x( t_p, M, false, x );
+
+    shape_h< ConcaveFunction >( x, M, f );
+
+    shape_f< S >( x, M, f );
+  }
+};
+
+//** Convex front. **********************************************************
+template< ShapeScaling S = WFGScaling >
+struct ConvexShape
+{
+  static const bool is_shape = true;
+
+  static void apply( const double* t_p, const int M, double* x, double* f )
+  {
+    shape_x( t_p, M, false, x );
+
+    shape_h< ConvexFunction >( x, M, f );
+
+    shape_f< S >( x, M, f );
+  }
+};
+
+//** Degenerate linear front (WFG3). ****************************************
+template< ShapeScaling S = WFGScaling >
+struct LinearDegenerateShape
+{
+  static const bool is_shape = true;
+
+  static void apply( const double* t_p, const int M, double* x, double* f )
+  {
+    shape_x( t_p, M, true, x );
+
+    shape_h< LinearFunction >( x, M, f );
+
+    shape_f< S >( x, M, f );
+  }
+};
+
+//** Convex front with a mixed last objective of A segments (WFG1). *********
+template< int A = 5, ShapeScaling S = WFGScaling >
+struct ConvexMixedShape
+{
+  static_assert( A >= 1, "mixed requires A >= 1" );
+
+  static const bool is_shape = true;
+
+  static void apply( const double* t_p, const int M, double* x, double* f )
+  {
+    shape_x( t_p, M, false, x );
+
+    shape_h< ConvexFunction >( x, M, f );
+
+    const double alpha = 1.0;
+    const double tmp   = 2.0*A*Misc::PI;
+
+    f[M-1] = InlineTransFunctions::correct_to_01(
+          std::pow( 1.0-x[0]-std::cos( tmp*x[0] + Misc::PI/2.0 )/tmp, alpha ) );
+
+    shape_f< S >( x, M, f );
+  }
+};
+
+//** Convex front with a disconnected last objective of A regions (WFG2). ***
+template< int A = 5, ShapeScaling S = WFGScaling >
+struct ConvexDiscShape
+{
+  static_assert( A >= 1, "disc requires A >= 1" );
+
+  static const bool is_shape = true;
+
+  static void apply( const double* t_p, const int M, double* x, double* f )
+  {
+    shape_x( t_p, M, false, x );
+
+    shape_h< ConvexFunction >( x, M, f );
+
+    const double alpha = 1.0;
+    const double beta  = 1.0;
+    const double tmp1  = A*std::pow( x[0], beta )*Misc::PI;
+
+    f[M-1] = InlineTransFunctions::correct_to_01(
+          1.0 - std::pow( x[0], alpha )*std::pow( std::cos( tmp1 ), 2.0 ) );
+
+    shape_f< S >( x, M, f );
+  }
+};
+
+
+//// Problems. //////////////////////////////////////////////////////////////
+
+//** Runs the stages in order; the last one must be a shape. ****************
+template< typename... Stages >
+struct Pipeline;
+
+template< typename Shape >
+struct Pipeline< Shape >
+{
+  static_assert( Shape::is_shape, "the last stage of a problem must be a shape" );
+
+  static void run
+  (
+    double* y,
+    int n,
+    const int,
+    const int M,
+    double* tmp,
+    double* f
+  )
+  {
+    assert( n == M );
+
+    Shape::apply( y, M, tmp, f );
+  }
+};
+
+template< typename Stage, typename... Rest >
+struct Pipeline< Stage, Rest... >
+{
+  static_assert( !Stage::is_shape, "a shape must be the last stage of a problem" );
+
+  static void run
+  (
+    double* y,
+    int n,
+    const int k,
+    const int M,
+    double* tmp,
+    double* f
+  )
+  {
+    Stage::apply( y, n, k, M, tmp );
+
+    Pipeline< Rest... >::run( y, n, k, M, tmp, f );
+  }
+};
+
+//** A WFG problem composed of transitions followed by a shape. *************
+template< typename... Stages >
+struct WFGProblem
+{
+  //** Doubles of workspace needed for "n" parameters. **********************
+  static int workspace_size( const int n )
+  {
+    return 3*n;
+  }
+
+  //** Evaluates "z" (n values) into "f" (M values), without allocating. ****
+  static void evaluate
+  (
+    const double* z,
+    const int n,
+    const int k,
+    const int M,
+    double* f,
+    double* workspace
+  )
+  {
+    assert( k >= 1 && k < n && M >= 2 && k % ( M-1 ) == 0 );
+
+    double* y   = workspace;
+    double* tmp = workspace + n;
+
+    std::copy( z, z + n, y );
+
+    Pipeline< Stages... >::run( y, n, k, M, tmp, f );
+  }
+
+  //** Evaluates "z", as the functions of ExampleProblems.h. ****************
+  static std::vector< double > evaluate
+  (
+    const std::vector< double >& z,
+    const int k,
+    const int M
+  )
+  {
+    const int n = static_cast< int >( z.size() );
+
+    std::vector< double > workspace( workspace_size( n ) );
+    std::vector< double > f( M );
+
+    evaluate( &z[0], n, k, M, &f[0], &workspace[0] );
+
+    return f;
+  }
+};
+
+
+//// The problems of ExampleProblems.h. /////////////////////////////////////
+
+namespace Examples
+{
+
+typedef WFGProblem< Normalise,
+                    SLinear< 35, 100, DistanceParams >,
+                    BFlat< 800, 750, 850, 1000, DistanceParams >,
+                    BPoly< 2, 100 >,
+                    RSum< LinearWeights >,
+                    ConvexMixedShape<> > WFG1;
+
+typedef WFGProblem< Normalise,
+                    SLinear< 35, 100, DistanceParams >,
+                    RNonsepPairs,
+                    RSum< UnitWeights >,
+                    ConvexDiscShape<> > WFG2;
+
+typedef WFGProblem< Normalise,
+                    SLinear< 35, 100, DistanceParams >,
+                    RNonsepPairs,
+                    RSum< UnitWeights >,
+                    LinearDegenerateShape<> > WFG3;
+
+typedef WFGProblem< Normalise,
+                    SMulti< 30, 1000, 35, 100 >,
+                    RSum< UnitWeights >,
+                    ConcaveShape<> > WFG4;
+
+typedef WFGProblem< Normalise,
+                    SDecept< 350, 1, 50, 1000 >,
+                    RSum< UnitWeights >,
+                    ConcaveShape<> > WFG5;
+
+typedef WFGProblem< Normalise,
+                    SLinear< 35, 100, DistanceParams >,
+                    RNonsep,
+                    ConcaveShape<> > WFG6;
+
+typedef WFGProblem< Normalise,
+                    BParamFollowing< PositionParams >,
+                    SLinear< 35, 100, DistanceParams >,
+                    RSum< UnitWeights >,
+                    ConcaveShape<> > WFG7;
+
+typedef WFGProblem< Normalise,
+                    BParamPreceding< DistanceParams >,
+                    SLinear< 35, 100, DistanceParams >,
+                    RSum< UnitWeights >,
+                    ConcaveShape<> > WFG8;
+
+typedef WFGProblem< Normalise,
+                    BParamFollowing<>,
+                    SDecept< 350, 1, 50, 1000, PositionParams >,
+                    SMulti< 30, 9500, 35, 100, DistanceParams >,
+                    RNonsep,
+                    ConcaveShape<> > WFG9;
+
+typedef WFGProblem< SLinear< 35, 100, DistanceParams >,
+                    RSum< UnitWeights >,
+                    ConcaveShape< UnitScaling > > I1;
+
+typedef WFGProblem< BParamFollowing<>,
+                    SLinear< 35, 100, DistanceParams >,
+                    RSum< UnitWeights >,
+                    ConcaveShape< UnitScaling > > I2;
+
+typedef WFGProblem< BParamPreceding<>,
+                    SLinear< 35, 100, DistanceParams >,
+                    RSum< UnitWeights >,
+                    ConcaveShape< UnitScaling > > I3;
+
+typedef WFGProblem< SLinear< 35, 100, DistanceParams >,
+                    RNonsep,
+                    ConcaveShape< UnitScaling > > I4;
+
+typedef WFGProblem< BParamPreceding<>,
+                    SLinear< 35, 100, DistanceParams >,
+                    RNonsep,
+                    ConcaveShape< UnitScaling > > I5;
+
+}  // Examples namespace
+
+}  // Composed namespace
+
+}  // Toolkit namespace
+
+}  // WFG namespace
+
+
+#endif
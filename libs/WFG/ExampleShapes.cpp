@@ -20,6 +20,9 @@
 
 
 /*
+ * Modified: the shapes use the whole-front shape functions and a TrigCache
+ *           of x, see ShapeFunctions.h.
+ *
  * 2006-03-28: Updated WFG_calculate_f() and I1_shape to employ a distance
  *             scaling constant D value of 1.0, as per changes introduced in
  *             the IEEE TEC review paper.
@@ -114,13 +117,12 @@ vector< double > Shapes::WFG1_shape( const vector< double >& t_p )
   const vector< short >&  A = WFG_create_A( M, false );
   const vector< double >& x = FrameworkFunctions::calculate_x( t_p, A );
 
-  vector< double > h;
+  ShapeFunctions::TrigCache trig;
+  trig.update( x );
 
-  for( int m = 1; m <= M-1; m++ )
-  {
-    h.push_back( ShapeFunctions::convex( x, m ) );
-  }
-  h.push_back( ShapeFunctions::mixed( x, 5, 1.0 ) );
+  vector< double > h;
+  ShapeFunctions::convex_front( trig, h );
+  h[M-1] = ShapeFunctions::mixed( x, 5, 1.0 );
 
   return WFG_calculate_f( x, h );
 }
@@ -135,13 +137,12 @@ vector< double > Shapes::WFG2_shape( const vector< double >& t_p )
   const vector< short >&  A = WFG_create_A( M, false );
   const vector< double >& x = FrameworkFunctions::calculate_x( t_p, A );
 
-  vector< double > h;
+  ShapeFunctions::TrigCache trig;
+  trig.update( x );
 
-  for( int m = 1; m <= M-1; m++ )
-  {
-    h.push_back( ShapeFunctions::convex( x, m ) );
-  }
-  h.push_back( ShapeFunctions::disc( x, 5, 1.0, 1.0 ) );
+  vector< double > h;
+  ShapeFunctions::convex_front( trig, h );
+  h[M-1] = ShapeFunctions::disc( x, 5, 1.0, 1.0 );
 
   return WFG_calculate_f( x, h );
 }
@@ -157,11 +158,7 @@ vector< double > Shapes::WFG3_shape( const vector< double >& t_p )
   const vector< double >& x = FrameworkFunctions::calculate_x( t_p, A );
 
   vector< double > h;
-
-  for( int m = 1; m <= M; m++ )
-  {
-    h.push_back( ShapeFunctions::linear( x, m ) );
-  }
+  ShapeFunctions::linear_front( x, h );
 
   return WFG_calculate_f( x, h );
 }
@@ -176,12 +173,11 @@ vector< double > Shapes::WFG4_shape( const vector< double >& t_p )
   const vector< short >&  A = WFG_create_A( M, false );
   const vector< double >& x = FrameworkFunctions::calculate_x( t_p, A );
 
-  vector< double > h;
+  ShapeFunctions::TrigCache trig;
+  trig.update( x );
 
-  for( int m = 1; m <= M; m++ )
-  {
-    h.push_back( ShapeFunctions::concave( x, m ) );
-  }
+  vector< double > h;
+  ShapeFunctions::concave_front( trig, h );
 
   return WFG_calculate_f( x, h );
 }
@@ -196,12 +192,11 @@ vector< double > Shapes::I1_shape( const vector< double >& t_p )
   const vector< short >&  A = WFG_create_A( M, false );
   const vector< double >& x = FrameworkFunctions::calculate_x( t_p, A );
 
-  vector< double > h;
+  ShapeFunctions::TrigCache trig;
+  trig.update( x );
 
-  for( int m = 1; m <= M; m++ )
-  {
-    h.push_back( ShapeFunctions::concave( x, m ) );
-  }
+  vector< double > h;
+  ShapeFunctions::concave_front( trig, h );
 
   return FrameworkFunctions::calculate_f( 1.0, x, h, vector< double >( M, 1.0 ) );
 }
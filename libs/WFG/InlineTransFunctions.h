@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2005 The Walking Fish Group (WFG).
+ *
+ * This material is provided "as is", with no warranty expressed or implied.
+ * Any use is at your own risk. Permission to use or copy this software for
+ * any purpose is hereby granted without fee, provided this notice is
+ * retained on all copies. Permission to modify the code and to distribute
+ * modified code is granted, provided a notice that the code was modified is
+ * included with the above copyright notice.
+ *
+ * http://www.wfg.csse.uwa.edu.au/
+ */
+
+
+/*
+ * InlineTransFunctions.h
+ *
+ * Inline versions of correct_to_01 and of the transformation functions of
+ * TransFunctions.h, without the argument checks, for the batch and composed
+ * problems. Each repeats the expression of the corresponding function term
+ * by term, so that the results are bit-identical.
+ *
+ * Modified: added to the toolkit for the batch and composed problems.
+ */
+
+
+#ifndef INLINE_TRANS_FUNCTIONS_H
+#define INLINE_TRANS_FUNCTIONS_H
+
+
+//// Standard includes. /////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+
+//// Toolkit includes. //////////////////////////////////////////////////////
+
+#include "Misc.h"
+
+
+//// Definitions/namespaces. ////////////////////////////////////////////////
+
+namespace WFGT
+{
+
+namespace Toolkit
+{
+
+namespace InlineTransFunctions
+{
+
+//** As Misc::correct_to_01, with the default epsilon. **********************
+inline double correct_to_01( const double a )
+{
+  const double epsilon = 1.0e-10;
+
+  const double min = 0.0;
+  const double max = 1.0;
+
+  const double min_epsilon = min - epsilon;
+  const double max_epsilon = max + epsilon;
+
+  if ( a <= min && a >= min_epsilon )
+  {
+    return min;
+  }
+  else if ( a >= max && a <= max_epsilon )
+  {
+    return max;
+  }
+  else
+  {
+    return a;
+  }
+}
+
+//** b_poly. ****************************************************************
+inline double b_poly( const double y, const double alpha )
+{
+  return correct_to_01( std::pow( y, alpha ) );
+}
+
+//** b_flat. ****************************************************************
+inline double b_flat
+(
+  const double y,
+  const double A,
+  const double B,
+  const double C
+)
+{
+  const double tmp1 = std::min( 0.0, std::floor( y-B ) ) * A*( B-y )/B;
+  const double tmp2 = std::min( 0.0, std::floor( C-y ) ) * ( 1.0-A )*( y-C )/( 1.0-C );
+
+  return correct_to_01( A+tmp1-tmp2 );
+}
+
+//** b_param. ***************************************************************
+inline double b_param
+(
+  const double y,
+  const double u,
+  const double A,
+  const double B,
+  const double C
+)
+{
+  const double v = A - ( 1.0-2.0*u )*std::fabs( std::floor( 0.5-u )+A );
+
+  return correct_to_01( std::pow( y, B + ( C-B )*v ) );
+}
+
+//** s_linear. **************************************************************
+inline double s_linear( const double y, const double A )
+{
+  return correct_to_01( std::fabs( y-A )/std::fabs( std::floor( A-y )+A ) );
+}
+
+//** s_decept. **************************************************************
+inline double s_decept
+(
+  const double y,
+  const double A,
+  const double B,
+  const double C
+)
+{
+  const double tmp1 = std::floor( y-A+B )*( 1.0-C+( A-B )/B )/( A-B );
+  const double tmp2 = std::floor( A+B-y )*( 1.0-C+( 1.0-A-B )/B )/( 1.0-A-B );
+
+  return correct_to_01( 1.0 + ( std::fabs( y-A )-B )*( tmp1 + tmp2 + 1.0/B ) );
+}
+
+//** s_multi. ***************************************************************
+inline double s_multi
+(
+  const double y,
+  const int A,
+  const double B,
+  const double C
+)
+{
+  const double tmp1 = std::fabs( y-C )/( 2.0*( std::floor( C-y )+C ) );
+  const double tmp2 = ( 4.0*A+2.0 )*Misc::PI*( 0.5-tmp1 );
+
+  return correct_to_01( ( 1.0 + std::cos( tmp2 ) + 4.0*B*std::pow( tmp1, 2.0 ) )/( B+2.0 ) );
+}
+
+/*
+ * In the WFG problems r_nonsep is always applied with A equal to the
+ * number of values, in which case its numerator is the sum of the values
+ * plus twice the sum of |y_i - y_j| over all pairs i < j. With the values
+ * sorted, y_(r) is larger than the r values before it and smaller than the
+ * len-1-r values after it, so the sum over pairs is that of
+ * ( 2r-len+1 )*y_(r): O(len*log(len)) instead of O(len^2). The two agree
+ * up to rounding, so the sorted form is only used for groups of at least
+ * r_nonsep_sort_size values, where the difference in cost matters, and
+ * only by the batch and composed engines. TransFunctions::r_nonsep keeps
+ * the nested sum of the original toolkit. With that many distance
+ * parameters, the batch and composed WFG6, WFG9, I4 and I5 therefore
+ * differ from ExampleProblems.h by rounding: about 1e-14 relative with
+ * 200 values and 1e-13 with 1000.
+ */
+
+//** Smallest group for which r_nonsep_numerator sorts the values. **********
+const int r_nonsep_sort_size = 32;
+
+//** The numerator of r_nonsep. "sorted" is scratch space for len values. ***
+inline double r_nonsep_numerator
+(
+  const double* y,
+  const int len,
+  const int A,
+  double* sorted
+)
+{
+  double numerator = 0.0;
+
+  if( A == len && len >= r_nonsep_sort_size )
+  {
+    std::copy( y, y + len, sorted );
+    std::sort( sorted, sorted + len );
+
+    double pairs = 0.0;
+
+    for( int r = 0; r < len; r++ )
+    {
+      numerator += y[r];
+      pairs     += ( 2.0*r - len + 1.0 )*sorted[r];
+    }
+
+    return numerator + 2.0*pairs;
+  }
+
+  for( int j = 0; j < len; j++ )
+  {
+    numerator += y[j];
+
+    for( int k = 0; k <= A-2; k++ )
+    {
+      numerator += std::fabs( y[j] - y[( j+k+1 ) % len] );
+    }
+  }
+
+  return numerator;
+}
+
+/*
+ * The b_param transitions of WFG7, WFG8, WFG9, I2 and I3 use as "u" the
+ * mean of the values that follow (precede) the one being transformed. The
+ * functions below keep that sum as a running total, which makes the
+ * transitions O(n) instead of O(n^2). The running prefix adds the values
+ * in the same order as r_sum, so b_param_preceding gives the same results
+ * as the direct form; the running suffix adds them from the last one
+ * down, so b_param_following may differ from it by rounding. b_param
+ * amplifies that rounding: the objectives of WFG7 and I2 move by about
+ * 1e-14 relative, those of WFG9 by up to about 6e-12. The running sums
+ * are only used by the batch and composed engines; the transitions of
+ * ExampleTransitions.h keep the r_sum of the original toolkit.
+ */
+
+//** b_param with the constants of the WFG problems. ************************
+inline double wfg_b_param( const double y, const double sum, const int len )
+{
+  const double u = correct_to_01( sum / len );
+
+  return b_param( y, u, 0.98/49.98, 0.02, 50 );
+}
+
+//** y[first], ..., y[last-1] (last < n) transformed by b_param, in place, **
+//** with "u" the mean of the original values that follow each one.        **
+inline void b_param_following
+(
+  double* y,
+  const int n,
+  const int first,
+  const int last
+)
+{
+  double sum = 0.0;
+
+  for( int i = n-1; i >= first; i-- )
+  {
+    const double y_i = y[i];
+
+    if( i < last )
+    {
+      y[i] = wfg_b_param( y_i, sum, n-1-i );
+    }
+
+    sum += y_i;
+  }
+}
+
+//** y[first], ..., y[last-1] (first > 0) transformed by b_param, in place, *
+//** with "u" the mean of the original values that precede each one.       **
+inline void b_param_preceding
+(
+  double* y,
+  const int first,
+  const int last
+)
+{
+  double sum = 0.0;
+
+  for( int i = 0; i < last; i++ )
+  {
+    const double y_i = y[i];
+
+    if( i >= first )
+    {
+      y[i] = wfg_b_param( y_i, sum, i );
+    }
+
+    sum += y_i;
+  }
+}
+
+}  // InlineTransFunctions namespace
+
+}  // Toolkit namespace
+
+}  // WFG namespace
+
+
+#endif
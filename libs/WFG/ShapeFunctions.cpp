@@ -16,6 +16,8 @@
  * ShapeFunctions.h
  *
  * Implementation of ShapeFunctions.h.
+ *
+ * Modified: added the whole-front versions of linear, convex and concave.
  */
 
 
@@ -154,3 +156,88 @@ double ShapeFunctions::disc
   const double tmp1 = A*pow( x[0], beta )*Misc::PI;
   return correct_to_01( 1.0 - pow( x[0], alpha )*pow( cos( tmp1 ), 2.0 ) );
 }
+
+void ShapeFunctions::TrigCache::update( const vector< double >& x )
+{
+  assert( Misc::vector_in_01( x ) );
+  assert( x.size() != 0 );
+
+  const int M = static_cast< int >( x.size() );
+
+  sin_x.resize( M-1 );
+  cos_x.resize( M-1 );
+
+  for( int i = 0; i < M-1; i++ )
+  {
+    sin_x[i] = sin( x[i]*Misc::PI/2.0 );
+    cos_x[i] = cos( x[i]*Misc::PI/2.0 );
+  }
+}
+
+void ShapeFunctions::linear_front
+(
+  const vector< double >& x,
+  vector< double >& h
+)
+{
+  assert( Misc::vector_in_01( x ) );
+  assert( x.size() != 0 );
+
+  const int M = static_cast< int >( x.size() );
+  double prefix = 1.0;
+
+  h.resize( M );
+
+  // h_m, for m = M-i, is the product of x[0..i-1] times 1-x[i].
+  for( int i = 0; i < M-1; i++ )
+  {
+    h[M-i-1] = correct_to_01( prefix*( 1 - x[i] ) );
+    prefix *= x[i];
+  }
+
+  h[0] = correct_to_01( prefix );
+}
+
+void ShapeFunctions::convex_front
+(
+  const TrigCache& trig,
+  vector< double >& h
+)
+{
+  assert( trig.sin_x.size() == trig.cos_x.size() );
+
+  const int M = static_cast< int >( trig.sin_x.size() ) + 1;
+  double prefix = 1.0;
+
+  h.resize( M );
+
+  for( int i = 0; i < M-1; i++ )
+  {
+    h[M-i-1] = correct_to_01( prefix*( 1.0 - trig.sin_x[i] ) );
+    prefix *= 1.0 - trig.cos_x[i];
+  }
+
+  h[0] = correct_to_01( prefix );
+}
+
+void ShapeFunctions::concave_front
+(
+  const TrigCache& trig,
+  vector< double >& h
+)
+{
+  assert( trig.sin_x.size() == trig.cos_x.size() );
+
+  const int M = static_cast< int >( trig.sin_x.size() ) + 1;
+  double prefix = 1.0;
+
+  h.resize( M );
+
+  for( int i = 0; i < M-1; i++ )
+  {
+    h[M-i-1] = correct_to_01( prefix*trig.cos_x[i] );
+    prefix *= trig.sin_x[i];
+  }
+
+  h[0] = correct_to_01( prefix );
+}
@@ -18,6 +18,8 @@
  * Defines the shape functions used by the WFG toolkit. For further
  * documentation, including the nature and arguments of each shape function,
  * refer to Table 1 of the EMO 2005 paper (available from the WFG web site).
+ *
+ * Modified: added the whole-front versions of linear, convex and concave.
  */
 
 
@@ -67,6 +69,34 @@ double disc
   const double& beta
 );
 
+/*
+ * The whole-front versions below give h_1..h_M in a single pass. The
+ * product over x[0..M-m-1] is shared by all the objectives as a prefix
+ * product, and the trigonometric values are taken from a TrigCache, so
+ * each sin( x[i]*PI/2 ) and cos( x[i]*PI/2 ) is evaluated once. The
+ * results are identical to calling the per-objective functions for
+ * m = 1..M.
+ */
+
+//** sin( x[i]*PI/2 ) and cos( x[i]*PI/2 ) for the first M-1 elements of x. *
+struct TrigCache
+{
+  //** Recompute the cached values for "x" (reusing the storage). ***********
+  void update( const std::vector< double >& x );
+
+  std::vector< double > sin_x;
+  std::vector< double > cos_x;
+};
+
+//** The linear shape function for m = 1..M, into "h". **********************
+void linear_front( const std::vector< double >& x, std::vector< double >& h );
+
+//** The convex shape function for m = 1..M, into "h". **********************
+void convex_front( const TrigCache& trig, std::vector< double >& h );
+
+//** The concave shape function for m = 1..M, into "h". *********************
+void concave_front( const TrigCache& trig, std::vector< double >& h );
+
 }  // ShapeFunctions namespace
 
 }  // Toolkit namespace
@@ -0,0 +1,148 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Heap allocations and time per evaluation of WFG1-9 and I1-I5, for the
+// scalar problems of ExampleProblems.h (one new vector per stage) and for
+// the workspace pipeline of BatchProblems.h with N = 1, given no workspace
+// and given a caller-owned one. Allocations are counted by replacing the
+// global operator new.
+#include <libs/WFG/ExampleProblems.h>
+#include <libs/WFG/BatchProblems.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace WFGT::Toolkit::Examples;
+using std::vector;
+
+namespace {
+
+long nAllocations = 0;
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    nAllocations++;
+    void* p = std::malloc(size ? size : 1);
+    if(p == 0) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+const int BenchRuns   = 7;
+const int EvalsPerRun = 2000;
+const int N = 24;
+const int K = 4;
+const int M = 3;
+
+typedef vector<double> (*ScalarProblem)(const vector<double>&, int, int);
+typedef void (*BatchProblem)(const double*, int, int, int, int, double*,
+                             double*);
+
+struct Problem
+{
+    const char*   name;
+    ScalarProblem scalar;
+    BatchProblem  batch;
+};
+
+const int NProblems = 14;
+const Problem TestProblems[NProblems] = {
+    {"WFG1", Problems::WFG1, BatchProblems::WFG1},
+    {"WFG2", Problems::WFG2, BatchProblems::WFG2},
+    {"WFG3", Problems::WFG3, BatchProblems::WFG3},
+    {"WFG4", Problems::WFG4, BatchProblems::WFG4},
+    {"WFG5", Problems::WFG5, BatchProblems::WFG5},
+    {"WFG6", Problems::WFG6, BatchProblems::WFG6},
+    {"WFG7", Problems::WFG7, BatchProblems::WFG7},
+    {"WFG8", Problems::WFG8, BatchProblems::WFG8},
+    {"WFG9", Problems::WFG9, BatchProblems::WFG9},
+    {"I1",   Problems::I1,   BatchProblems::I1},
+    {"I2",   Problems::I2,   BatchProblems::I2},
+    {"I3",   Problems::I3,   BatchProblems::I3},
+    {"I4",   Problems::I4,   BatchProblems::I4},
+    {"I5",   Problems::I5,   BatchProblems::I5}
+};
+
+volatile double sink = 0.0;
+
+// allocations of one call of body(), and its best time in microseconds
+template<typename Body>
+void measure(Body body, long& allocations, double& us)
+{
+    long before = nAllocations;
+    body();
+    allocations = nAllocations - before;
+
+    us = 1e300;
+    for(int k=0; k<BenchRuns; k++) {
+        auto start = std::chrono::steady_clock::now();
+        for(int e=0; e<EvalsPerRun; e++) {
+            body();
+        }
+        auto stop = std::chrono::steady_clock::now();
+        us = std::min(us, std::chrono::duration<double, std::micro>(
+                              stop-start).count() / EvalsPerRun);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    // a point inside the box of the WFG problems and of the I problems
+    vector<double> z(N);
+    for(int i=0; i<N; i++) {
+        z[i] = 0.3 + 0.02*i;
+    }
+    vector<double> f(M);
+    vector<double> workspace(BatchProblems::workspace_size(N, 1, M));
+
+    printf("n=%d k=%d M=%d\n", N, K, M);
+    printf("%-6s %20s %20s %20s\n", "", "scalar", "batch, no workspace",
+           "batch, workspace");
+    printf("%-6s %10s %9s %10s %9s %10s %9s\n", "",
+           "allocs", "us", "allocs", "us", "allocs", "us");
+    for(int p=0; p<NProblems; p++) {
+        const Problem& pr = TestProblems[p];
+        long aScalar, aOwn, aCaller;
+        double tScalar, tOwn, tCaller;
+        measure([&]() { sink = pr.scalar(z, K, M)[0]; }, aScalar, tScalar);
+        measure([&]() {
+            pr.batch(z.data(), N, 1, K, M, f.data(), 0);
+            sink = f[0];
+        }, aOwn, tOwn);
+        measure([&]() {
+            pr.batch(z.data(), N, 1, K, M, f.data(), workspace.data());
+            sink = f[0];
+        }, aCaller, tCaller);
+
+        printf("%-6s %10ld %9.3f %10ld %9.3f %10ld %9.3f\n", pr.name,
+               aScalar, tScalar, aOwn, tOwn, aCaller, tCaller);
+    }
+    return 0;
+}
@@ -0,0 +1,22 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+TARGET = AllocationBenchmark
+# the benchmarks share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += AllocationBenchmark.cpp \
+    ../libs/WFG/BatchProblems.cpp \
+    ../libs/WFG/ExampleProblems.cpp \
+    ../libs/WFG/ExampleShapes.cpp \
+    ../libs/WFG/ExampleTransitions.cpp \
+    ../libs/WFG/FrameworkFunctions.cpp \
+    ../libs/WFG/Misc.cpp \
+    ../libs/WFG/ShapeFunctions.cpp \
+    ../libs/WFG/TransFunctions.cpp
@@ -0,0 +1,163 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Time of the b_param transitions (WFG7_t1, WFG8_t1, WFG9_t1, which is also
+// I2_t1, and I3_t1) over the number of variables n, with the running sums
+// of InlineTransFunctions.h used by the batch and composed problems, and
+// with the r_sum over a fresh subvector per variable that ExampleTransitions
+// keeps. Prints the best of several runs per call and the largest relative
+// difference between the two outputs over a set of random inputs.
+#include <libs/WFG/ExampleTransitions.h>
+#include <libs/WFG/InlineTransFunctions.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace WFGT::Toolkit;
+using std::vector;
+
+namespace {
+
+const int BenchRuns = 7;
+const int K         = 10;
+const int NInputs   = 50;
+// about this many r_sum terms of the r_sum form per run
+const double TermsPerRun = 2e7;
+
+volatile double sink = 0.0;
+
+// The r_sum form of ExampleTransitions
+
+vector<double> oldWFG7(const vector<double>& y)
+{
+    return Examples::Transitions::WFG7_t1(y, K);
+}
+
+vector<double> oldWFG8(const vector<double>& y)
+{
+    return Examples::Transitions::WFG8_t1(y, K);
+}
+
+// The running sums of the batch and composed problems
+
+vector<double> newWFG7(const vector<double>& y)
+{
+    vector<double> t = y;
+    InlineTransFunctions::b_param_following(t.data(), t.size(), 0, K);
+    return t;
+}
+
+vector<double> newWFG8(const vector<double>& y)
+{
+    vector<double> t = y;
+    InlineTransFunctions::b_param_preceding(t.data(), K, t.size());
+    return t;
+}
+
+vector<double> newWFG9(const vector<double>& y)
+{
+    vector<double> t = y;
+    int n = t.size();
+    InlineTransFunctions::b_param_following(t.data(), n, 0, n-1);
+    return t;
+}
+
+vector<double> newI3(const vector<double>& y)
+{
+    vector<double> t = y;
+    InlineTransFunctions::b_param_preceding(t.data(), 1, t.size());
+    return t;
+}
+
+typedef vector<double> (*Transition)(const vector<double>&);
+
+struct Case
+{
+    const char* name;
+    Transition  oldT;
+    Transition  newT;
+};
+
+const int NCases = 4;
+const Case Cases[NCases] = {
+    {"WFG7_t1", oldWFG7, newWFG7},
+    {"WFG8_t1", oldWFG8, newWFG8},
+    {"WFG9_t1", Examples::Transitions::WFG9_t1, newWFG9},
+    {"I3_t1",   Examples::Transitions::I3_t1,   newI3}
+};
+
+// best time per call, in microseconds
+double timeCall(Transition t, const vector<double>& y, int calls)
+{
+    double best = 1e300;
+    for(int k=0; k<BenchRuns; k++) {
+        auto start = std::chrono::steady_clock::now();
+        for(int c=0; c<calls; c++) {
+            sink = sink + t(y)[0];
+        }
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(
+                                  stop-start).count() / calls);
+    }
+    return best;
+}
+
+} // namespace
+
+int main()
+{
+    const int nSizes = 5;
+    const int sizes[nSizes] = {24, 100, 300, 1000, 4000};
+
+    std::mt19937 gen(9);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    printf("k=%d for WFG7_t1 and WFG8_t1\n", K);
+    printf("%-8s %6s %12s %12s %10s\n",
+           "", "n", "old (us)", "new (us)", "rel diff");
+    for(int c=0; c<NCases; c++) {
+        for(int s=0; s<nSizes; s++) {
+            int n = sizes[s];
+            vector<vector<double> > inputs(NInputs, vector<double>(n));
+            for(int j=0; j<NInputs; j++) {
+                for(int i=0; i<n; i++) {
+                    inputs[j][i] = uni(gen);
+                }
+            }
+
+            int calls = std::max(1, (int)(TermsPerRun / ((double)n*n)));
+            double tOld = timeCall(Cases[c].oldT, inputs[0], calls);
+            double tNew = timeCall(Cases[c].newT, inputs[0], calls);
+
+            double worst = 0.0;
+            for(int j=0; j<NInputs; j++) {
+                vector<double> a = Cases[c].oldT(inputs[j]);
+                vector<double> b = Cases[c].newT(inputs[j]);
+                for(int i=0; i<n; i++) {
+                    if(a[i] != 0.0) {
+                        worst = std::max(worst,
+                                         std::fabs(b[i] - a[i]) / a[i]);
+                    }
+                }
+            }
+            printf("%-8s %6d %12.2f %12.2f %10.1e\n", Cases[c].name, n,
+                   tOld, tNew, worst);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,16 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+
+TARGET = BParamBenchmark
+# the benchmarks share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += BParamBenchmark.cpp \
+    ../libs/WFG/ExampleTransitions.cpp \
+    ../libs/WFG/TransFunctions.cpp \
+    ../libs/WFG/Misc.cpp
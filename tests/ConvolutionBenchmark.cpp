@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Time of the direct and the FFT convolution of two equal-length inputs,
+// over the range of grid sizes where ConvFFTMinNSamples is chosen. Prints
+// the best of several runs per call, the largest difference between the
+// two results, and the method convolve() dispatches to. Then times a sum
+// chain of k inputs, convolved in turn and in a single transform.
+#include <core/utils/Convolution.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace CODeM;
+
+namespace {
+
+const int BenchRuns   = 7;
+const int CallsPerRun = 200;
+
+// best time per call, in microseconds
+double timeCall(vector<double> (*conv)(const vector<double>&,
+                                       const vector<double>&),
+                const vector<double>& a, const vector<double>& b)
+{
+    double best = 1e300;
+    volatile double sink = 0.0;
+    for(int k=0; k<BenchRuns; k++) {
+        auto start = std::chrono::steady_clock::now();
+        for(int c=0; c<CallsPerRun; c++) {
+            sink = sink + conv(a, b)[0];
+        }
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(
+                                  stop-start).count() / CallsPerRun);
+    }
+    return best;
+}
+
+} // namespace
+
+int main()
+{
+    const int nSizes = 21;
+    const int sizes[nSizes] = {64, 128, 144, 160, 176, 192, 224, 248, 256,
+                               257, 272, 288, 300, 320, 340, 360, 400, 512,
+                               1024, 2048, 4096};
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    printf("%6s %12s %12s %10s %8s\n",
+           "n", "direct (us)", "fft (us)", "max diff", "chosen");
+    for(int s=0; s<nSizes; s++) {
+        int n = sizes[s];
+        vector<double> a(n);
+        vector<double> b(n);
+        for(int i=0; i<n; i++) {
+            a[i] = uni(gen);
+            b[i] = uni(gen);
+        }
+
+        double tDirect = timeCall(directConvolution, a, b);
+        double tFFT    = timeCall(fftConvolution, a, b);
+
+        vector<double> d = directConvolution(a, b);
+        vector<double> f = fftConvolution(a, b);
+        double maxDiff = 0.0;
+        for(size_t i=0; i<d.size(); i++) {
+            maxDiff = std::max(maxDiff, std::abs(d[i] - f[i]));
+        }
+
+        printf("%6d %12.2f %12.2f %10.1e %8s\n", n, tDirect, tFFT, maxDiff,
+               (n < ConvFFTMinNSamples) ? "direct" : "fft");
+    }
+
+    const int nChainSizes = 3;
+    const int chainSizes[nChainSizes] = {256, 512, 1024};
+    printf("\n%6s %3s %12s %12s %10s\n",
+           "n", "k", "in turn (us)", "fused (us)", "max diff");
+    for(int s=0; s<nChainSizes; s++) {
+        int n = chainSizes[s];
+        for(int k=3; k<=6; k+=3) {
+            vector<vector<double> > inputs(k, vector<double>(n));
+            for(int j=0; j<k; j++) {
+                for(int i=0; i<n; i++) {
+                    inputs[j][i] = uni(gen);
+                }
+            }
+
+            double tTurn  = 1e300;
+            double tFused = 1e300;
+            vector<double> t;
+            vector<double> f;
+            for(int r=0; r<BenchRuns; r++) {
+                auto start = std::chrono::steady_clock::now();
+                t = inputs[0];
+                for(int j=1; j<k; j++) {
+                    t = convolve(t, inputs[j]);
+                }
+                auto mid = std::chrono::steady_clock::now();
+                f = convolve(inputs);
+                auto stop = std::chrono::steady_clock::now();
+                tTurn  = std::min(tTurn, std::chrono::duration<double,
+                                  std::micro>(mid-start).count());
+                tFused = std::min(tFused, std::chrono::duration<double,
+                                  std::micro>(stop-mid).count());
+            }
+            double maxDiff = 0.0;
+            double largest = 0.0;
+            for(size_t i=0; i<t.size(); i++) {
+                maxDiff = std::max(maxDiff, std::abs(t[i] - f[i]));
+                largest = std::max(largest, std::abs(t[i]));
+            }
+            printf("%6d %3d %12.2f %12.2f %10.1e\n", n, k, tTurn, tFused,
+                   maxDiff/largest);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+
+TARGET = ConvolutionBenchmark
+# the benchmarks share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += ConvolutionBenchmark.cpp \
+    ../core/utils/Convolution.cpp
@@ -0,0 +1,179 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Checks of the batch DTLZ problems against the scalar DTLZ1 and DTLZ2,
+// and of the sin/cos kernel against libm. Each check prints a line and the
+// program returns the number of failed checks.
+#include <libs/DTLZ/DTLZBatchProblems.h>
+#include <libs/DTLZ/DTLZProblems.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using std::vector;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool passed, const char* name, double value)
+{
+    printf("%s %s (%g)\n", passed ? "PASS" : "FAIL", name, value);
+    if(!passed) {
+        nFailures++;
+    }
+}
+
+// The batch and scalar problems differ only through sin and cos
+const double ProblemTolerance = 2e-15;
+
+typedef vector<double> (*ScalarProblem)(const vector<double>&, const int);
+typedef void (*BatchProblem)(const double*, int, int, int, double*, double*);
+
+// Largest difference between the batch and the scalar problem, relative to
+// max(1, |f|), over N individuals. The first rows are all 0, all 1 and
+// all 0.5; the others are random.
+double batchDifference(ScalarProblem scalar, BatchProblem batch, int n, int M)
+{
+    const int N = 101;
+    std::mt19937 gen(n*M);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    vector<double> X(N*n);
+    for(int j=0; j<N; j++) {
+        for(int i=0; i<n; i++) {
+            X[j*n+i] = (j == 0) ? 0.0 : (j == 1) ? 1.0 : (j == 2) ? 0.5
+                                                                  : uni(gen);
+        }
+    }
+
+    // the batch problems take structure-of-arrays blocks
+    vector<double> x(n*N);
+    for(int j=0; j<N; j++) {
+        for(int i=0; i<n; i++) {
+            x[i*N+j] = X[j*n+i];
+        }
+    }
+    vector<double> f(M*N);
+    vector<double> workspace(DTLZ::Batch::workspaceSize(N));
+    batch(x.data(), n, N, M, f.data(), workspace.data());
+
+    double worst = 0.0;
+    for(int j=0; j<N; j++) {
+        vector<double> xj(X.begin()+j*n, X.begin()+(j+1)*n);
+        vector<double> ref = scalar(xj, M);
+        for(int m=0; m<M; m++) {
+            double d = std::abs(f[m*N+j] - ref[m]);
+            worst = std::max(worst, d / std::max(1.0, std::abs(ref[m])));
+        }
+    }
+    return worst;
+}
+
+void testAgainstScalar()
+{
+    const int nSettings = 4;
+    const int settings[nSettings][2] = {{7, 3}, {12, 3}, {12, 5}, {30, 2}};
+
+    double worst1 = 0.0;
+    double worst2 = 0.0;
+    for(int s=0; s<nSettings; s++) {
+        int n = settings[s][0];
+        int M = settings[s][1];
+        worst1 = std::max(worst1, batchDifference(DTLZ::DTLZ1,
+                                                  DTLZ::Batch::DTLZ1, n, M));
+        worst2 = std::max(worst2, batchDifference(DTLZ::DTLZ2,
+                                                  DTLZ::Batch::DTLZ2, n, M));
+    }
+    check(worst1 <= ProblemTolerance, "batch DTLZ1 matches the scalar DTLZ1",
+          worst1);
+    check(worst2 <= ProblemTolerance, "batch DTLZ2 matches the scalar DTLZ2",
+          worst2);
+}
+
+double ulp(double v)
+{
+    v = std::abs(v);
+    return std::nextafter(v, 2.0*v + 1.0) - v;
+}
+
+// Within 2 ulp of libm for |a| < 1e6, or 1e-25 absolute close to the zeros
+// of sin and cos, where the reduction by pi/2 limits the accuracy
+void testSinCos()
+{
+    const int nRanges = 5;
+    const double ranges[nRanges] = {1.0, 10.0, 1e3, 1e5, 1e6};
+    const int nPerRange = 100000;
+    std::mt19937_64 gen(3);
+
+    vector<double> a;
+    for(int r=0; r<nRanges; r++) {
+        std::uniform_real_distribution<double> uni(-ranges[r], ranges[r]);
+        for(int i=0; i<nPerRange; i++) {
+            a.push_back(uni(gen));
+        }
+    }
+    // the multiples of pi/2, where one of the two is close to 0
+    for(int q=0; q*1.5707963267948966<1e6; q+=7) {
+        a.push_back(q*1.5707963267948966);
+    }
+
+    int N = a.size();
+    vector<double> s(N);
+    vector<double> c(N);
+    DTLZ::Batch::sinCos(a.data(), N, s.data(), c.data());
+
+    int nOutside = 0;
+    double worst = 0.0;
+    for(int j=0; j<N; j++) {
+        double rs = std::sin(a[j]);
+        double rc = std::cos(a[j]);
+        double es = std::abs(s[j] - rs);
+        double ec = std::abs(c[j] - rc);
+        nOutside += (es > 2.0*ulp(rs) + 1e-25);
+        nOutside += (ec > 2.0*ulp(rc) + 1e-25);
+        worst = std::max(worst, std::max(es, ec));
+    }
+    check(nOutside == 0, "sinCos is within 2 ulp of libm", nOutside);
+    check(worst <= 2.3e-16, "sinCos absolute error", worst);
+
+    // one output only gives the same values
+    vector<double> s1(N);
+    vector<double> c1(N);
+    DTLZ::Batch::sinCos(a.data(), N, s1.data(), 0);
+    DTLZ::Batch::sinCos(a.data(), N, 0, c1.data());
+    int nDiff = 0;
+    for(int j=0; j<N; j++) {
+        nDiff += (s1[j] != s[j]) + (c1[j] != c[j]);
+    }
+    check(nDiff == 0, "sin or cos alone matches sinCos", nDiff);
+
+    double zero = 0.0;
+    double sz, cz;
+    DTLZ::Batch::sinCos(&zero, 1, &sz, &cz);
+    check(sz == 0.0 && cz == 1.0, "sinCos(0) is (0, 1)", sz);
+}
+
+} // namespace
+
+int main()
+{
+    testAgainstScalar();
+    testSinCos();
+
+    printf("%d failed\n", nFailures);
+    return nFailures;
+}
@@ -0,0 +1,17 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+# "make check" runs the target
+CONFIG += testcase
+
+TARGET = DTLZTests
+# the test programs share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += DTLZTests.cpp \
+    ../libs/DTLZ/DTLZBatchProblems.cpp \
+    ../libs/DTLZ/DTLZProblems.cpp
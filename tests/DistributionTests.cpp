@@ -0,0 +1,617 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Checks of the distribution kernels and samplers. Each check prints a line
+// and the program returns the number of failed checks.
+#include <core/RandomDistributions.h>
+#include <core/PeakDistributionCache.h>
+#include <core/DistributionExpression.h>
+#include <core/utils/RandomStream.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+
+using namespace CODeM;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool passed, const char* name, double value)
+{
+    printf("%s %s (%g)\n", passed ? "PASS" : "FAIL", name, value);
+    if(!passed) {
+        nFailures++;
+    }
+}
+
+// Kolmogorov-Smirnov distance between the samples and the cdf of d
+double ksDistance(vector<double> samples, IDistribution* d)
+{
+    std::sort(samples.begin(), samples.end());
+    int n = samples.size();
+    double dMax = 0.0;
+    for(int i=0; i<n; i++) {
+        double c = d->cdf(samples[i]);
+        dMax = std::max(dMax, std::max(c - (double)i/n, (double)(i+1)/n - c));
+    }
+    return dMax;
+}
+
+vector<double> drawSamples(IDistribution* d, int n, uint64_t seed)
+{
+    RandomStream stream(seed);
+    ScopedRandomStream guard(&stream);
+    vector<double> samples(n);
+    for(int i=0; i<n; i++) {
+        samples[i] = d->sample();
+    }
+    return samples;
+}
+
+const int    NPeakParameters = 4;
+const double PeakParameters[NPeakParameters][2] = {
+    {0.5, 1.0}, {0.2, 0.3}, {0.9, 0.0}, {0.05, 0.8}
+};
+
+// The guide table inverts the same piecewise-linear cdf as the quantile
+// interpolator: the same uniforms give the same draws, and both follow the
+// tabulated cdf.
+void testGuideTableSampling()
+{
+    const int nDraws = 20000;
+    // 99.9% critical value of the one-sample KS statistic
+    const double ksCritical = 1.95 / std::sqrt((double)nDraws);
+
+    for(int p=0; p<NPeakParameters; p++) {
+        PeakDistribution interp(PeakParameters[p][0], PeakParameters[p][1]);
+        PeakDistribution guide(PeakParameters[p][0], PeakParameters[p][1]);
+        interp.defineSamplingMethod(InterpolatorSampling);
+        guide.defineSamplingMethod(GuideTableSampling);
+
+        vector<double> a = drawSamples(&interp, nDraws, 17 + p);
+        vector<double> b = drawSamples(&guide,  nDraws, 17 + p);
+
+        double range = guide.upperBound() - guide.lowerBound();
+        double maxDiff = 0.0;
+        for(int i=0; i<nDraws; i++) {
+            maxDiff = std::max(maxDiff, std::abs(a[i] - b[i]));
+        }
+        check(maxDiff <= 1e-9*range,
+              "guide table draws equal the interpolator draws", maxDiff);
+
+        double ksInterp = ksDistance(a, &interp);
+        double ksGuide  = ksDistance(b, &guide);
+        check(ksInterp < ksCritical, "interpolator draws follow the cdf",
+              ksInterp);
+        check(ksGuide  < ksCritical, "guide table draws follow the cdf",
+              ksGuide);
+    }
+}
+
+// The PeakDistribution pdf as computed before the Chebyshev kernel: a
+// complex sum of the eigenfunctions, each evaluated with sin(). The Poisson
+// weights are taken in log form so that n! cannot overflow.
+vector<double> referencePeakPDF(const vector<double>& z, double tendency,
+                                double locality)
+{
+    int nSamples = z.size();
+    double lb = z[0];
+    double ub = z[nSamples-1];
+    double pi = boost::math::constants::pi<double>();
+
+    double shift = pi * tendency;
+    double N = Tigon::DistPeakMinN + locality
+            * (Tigon::DistPeakMaxN - Tigon::DistPeakMinN);
+    double nMax = std::max(3*N, (double)Tigon::DistPeakMinNBasisFunc);
+    nMax = std::min(nMax, (double)Tigon::DistPeakMaxNBasisFunc);
+    double Lz = ub - lb;
+    double An = std::sqrt(2.0/Lz);
+
+    vector<std::complex<double> > psiN(nSamples, std::complex<double>(0, 0));
+    std::complex<double> j(0, 1);
+    for(double n=1.0; n<=nMax; n++) {
+        double cNn = std::sqrt(std::exp(n*std::log(N) - N
+                                        - std::lgamma(n+1.0)));
+        for(int i=1; i<nSamples-1; i++) {
+            double psi = An*std::sin(pi*n*(z[i]-lb)/Lz);
+            psiN[i] += cNn * std::exp(-j*shift*(n+0.5)) * psi;
+        }
+    }
+
+    vector<double> pdf(nSamples);
+    for(int i=0; i<nSamples; i++) {
+        pdf[i] = std::norm(psiN[i]);
+    }
+
+    // the trapezoidal normalisation of IDistribution::calculateCDF(), which
+    // falls back to a uniform pdf when the area is zero
+    double area = 0.0;
+    for(int i=0; i<nSamples-1; i++) {
+        area += (pdf[i]+pdf[i+1])/2 * (z[i+1]-z[i]);
+    }
+    for(int i=0; i<nSamples; i++) {
+        pdf[i] = (area > 0.0) ? pdf[i]/area : 1.0/Lz;
+    }
+    return pdf;
+}
+
+// The Chebyshev recurrence of PeakDistribution::generatePeakPDF() agrees
+// with the direct evaluation to 1e-12 of the peak density.
+void testPeakPDFKernel()
+{
+    PeakDistributionCache* cache = PeakDistributionCache::instance();
+    bool wasEnabled = cache->isEnabled();
+    cache->defineEnabled(false);
+
+    for(int p=0; p<NPeakParameters; p++) {
+        PeakDistribution d(PeakParameters[p][0], PeakParameters[p][1]);
+        vector<double> pdf = d.pdf();
+        vector<double> ref = referencePeakPDF(d.zSamples(),
+                                              PeakParameters[p][0],
+                                              PeakParameters[p][1]);
+
+        double peak = *std::max_element(ref.begin(), ref.end());
+        int nSamples = ref.size();
+        double maxDiff = 0.0;
+        for(int i=0; i<nSamples; i++) {
+            maxDiff = std::max(maxDiff, std::abs(pdf[i] - ref[i]));
+        }
+        check(maxDiff <= 1e-12*peak, "peak pdf matches the direct kernel",
+              maxDiff/peak);
+    }
+
+    cache->defineEnabled(wasEnabled);
+}
+
+// With a tolerance, localities that quantise to the same value share one
+// grid and one cache entry
+void testPeakCacheHitRate()
+{
+    PeakDistributionCache* cache = PeakDistributionCache::instance();
+    bool   wasEnabled = cache->isEnabled();
+    double tolerance  = cache->tolerance();
+    cache->defineEnabled(true);
+    cache->defineTolerance(0.01);
+    cache->clear();
+
+    const int    nLocalities = 4;
+    const double localities[nLocalities] = {0.5, 0.501, 0.502, 0.503};
+    long long hits   = cache->hits();
+    long long misses = cache->misses();
+    int nSamples = -1;
+    bool sameGrid = true;
+    for(int l=0; l<nLocalities; l++) {
+        PeakDistribution d(0.3, localities[l]);
+        int n = d.pdf().size();
+        sameGrid = sameGrid && (nSamples < 0 || n == nSamples);
+        nSamples = n;
+    }
+    hits   = cache->hits()   - hits;
+    misses = cache->misses() - misses;
+
+    check(sameGrid, "quantised localities share the grid", nSamples);
+    check(hits == nLocalities-1 && misses == 1,
+          "quantised localities hit the cache",
+          (double)hits/(hits+misses));
+
+    cache->defineTolerance(tolerance);
+    cache->clear();
+    cache->defineEnabled(wasEnabled);
+}
+
+// The cache evicts least recently used entries to stay within its byte
+// capacity
+void testPeakCacheMemoryBound()
+{
+    PeakDistributionCache* cache = PeakDistributionCache::instance();
+    bool   wasEnabled = cache->isEnabled();
+    double tolerance  = cache->tolerance();
+    size_t capacity   = cache->capacity();
+    cache->defineEnabled(true);
+    cache->defineTolerance(0.0);
+    cache->clear();
+
+    PeakDistribution first(0.1, 0.5);
+    first.pdf();
+    size_t entryBytes = cache->memoryUsage();
+    cache->defineCapacity(3*entryBytes);
+
+    const int nTendencies = 8;
+    size_t largest = 0;
+    for(int t=0; t<nTendencies; t++) {
+        PeakDistribution d(0.2 + 0.1*t, 0.5);
+        d.pdf();
+        largest = std::max(largest, cache->memoryUsage());
+    }
+    check(entryBytes > 0 && largest <= 3*entryBytes && cache->size() == 3,
+          "the cache stays within its byte capacity", (double)largest);
+
+    cache->defineCapacity(capacity);
+    cache->defineTolerance(tolerance);
+    cache->clear();
+    cache->defineEnabled(wasEnabled);
+}
+
+// Quantised parameters stay in [0,1] when the nearest grid point does not
+void testPeakCacheQuantiseBounds()
+{
+    double top    = PeakDistributionCache::quantise(1.0, 0.4);
+    double bottom = PeakDistributionCache::quantise(0.0, 0.4);
+    check(top == 1.0 && bottom == 0.0, "quantised parameters stay in [0,1]",
+          top);
+}
+
+// Instances with the same key draw from one shared table, and the draws
+// are those of an instance with its own copy of the tables
+void testPeakCacheSharedSampling()
+{
+    PeakDistributionCache* cache = PeakDistributionCache::instance();
+    bool   wasEnabled = cache->isEnabled();
+    double tolerance  = cache->tolerance();
+    cache->defineEnabled(true);
+    cache->defineTolerance(0.0);
+    cache->clear();
+
+    const int nDraws = 1000;
+    PeakDistribution first(0.3, 0.6);
+    PeakDistribution second(0.3, 0.6);
+    vector<double> a = drawSamples(&first,  nDraws, 5);
+    vector<double> b = drawSamples(&second, nDraws, 5);
+    check(cache->hits() == 1 && cache->misses() == 1,
+          "instances share the cached sampler", cache->size());
+
+    PeakDistribution copied(0.3, 0.6);
+    copied.pdf();
+    vector<double> c = drawSamples(&copied, nDraws, 5);
+    bool same = true;
+    for(int i=0; i<nDraws; i++) {
+        same = same && a[i] == b[i] && a[i] == c[i];
+    }
+    check(same, "shared and copied tables give the same draws", nDraws);
+
+    cache->defineTolerance(tolerance);
+    cache->clear();
+    cache->defineEnabled(wasEnabled);
+}
+
+// Composition sampling draws from the ratio-weighted mixture of the
+// components, without building the merged grid
+void testMergedCompositionSampling()
+{
+    const int nDraws = 20000;
+    const double ksCritical = 1.95 / std::sqrt((double)nDraws);
+
+    UniformDistribution low(0.0, 1.0);
+    UniformDistribution high(2.0, 3.0);
+    MergedDistribution merged;
+    merged.appendDistribution(low.clone(),  1.0);
+    merged.appendDistribution(high.clone(), 3.0);
+    merged.appendDistribution(new UniformDistribution(5.0, 6.0), 0.0);
+
+    vector<double> samples = drawSamples(&merged, nDraws, 23);
+    std::sort(samples.begin(), samples.end());
+    double dMax = 0.0;
+    for(int i=0; i<nDraws; i++) {
+        double c = 0.25*low.cdf(samples[i]) + 0.75*high.cdf(samples[i]);
+        dMax = std::max(dMax, std::max(c - (double)i/nDraws,
+                                       (double)(i+1)/nDraws - c));
+    }
+    check(merged.nDistributions() == 2,
+          "a component with a zero ratio is not appended",
+          merged.nDistributions());
+    check(dMax < ksCritical, "composition draws follow the mixture", dMax);
+    check(merged.resolution() > 0.0 &&
+          merged.resolution() <= std::min(low.resolution(),
+                                          high.resolution()),
+          "merged resolution follows the components", merged.resolution());
+}
+
+// After an operation the merged grid is the only component, and the draws
+// follow it
+void testMergedCollapse()
+{
+    const int nDraws = 20000;
+    const double ksCritical = 1.95 / std::sqrt((double)nDraws);
+
+    MergedDistribution merged;
+    merged.appendDistribution(new UniformDistribution(0.0, 2.0), 1.0);
+    merged.appendDistribution(new UniformDistribution(1.0, 3.0), 1.0);
+    merged.add(1.0);
+
+    check(merged.nDistributions() == 1, "operations collapse the components",
+          merged.nDistributions());
+    check(std::abs(merged.mean() - 2.5) < 1e-2,
+          "collapsed distribution keeps the shifted mean", merged.mean());
+
+    vector<double> samples = drawSamples(&merged, nDraws, 29);
+    double ks = ksDistance(samples, &merged);
+    check(ks < ksCritical, "collapsed draws follow the merged cdf", ks);
+}
+
+// cdf of X*Y, or X/Y, at z by the midpoint rule over X (product) or over
+// the one-signed Y (quotient)
+double referenceProductCdf(IDistribution* x, IDistribution* y, bool divide,
+                           double z, int n)
+{
+    IDistribution* d = divide ? y : x;
+    IDistribution* e = divide ? x : y;
+    double a = d->lowerBound();
+    double h = (d->upperBound() - a) / n;
+    double F = 0.0;
+    for(int i=0; i<n; i++) {
+        double v = a + (i+0.5)*h;
+        double p = d->pdf(v) * h;
+        double c = divide ? e->cdf(z*v) : e->cdf(z/v);
+        F += (v > 0.0) ? p*c : p*(1.0-c);
+    }
+    return F;
+}
+
+IDistribution* peakOn(double tendency, double locality, double lb, double ub)
+{
+    PeakDistribution* d = new PeakDistribution(tendency, locality);
+    d->pdf();
+    d->affineTransform(ub-lb, lb);
+    return d;
+}
+
+// Products and quotients of one-signed distributions, computed by the
+// log-domain convolution, agree with a direct integration of the cdf
+void testOneSignedProduct()
+{
+    const int nCases = 4;
+    IDistribution* x[nCases] = {peakOn(0.3, 0.5,  1.0,  2.0),
+                                peakOn(0.6, 0.4, -2.0, -1.0),
+                                peakOn(0.4, 0.6,  1.0,  2.0),
+                                peakOn(0.8, 0.9, -3.0, -1.0)};
+    IDistribution* y[nCases] = {peakOn(0.7, 0.8,  0.5,  3.0),
+                                peakOn(0.2, 0.7,  1.0,  3.0),
+                                peakOn(0.5, 0.5,  0.5,  1.5),
+                                peakOn(0.3, 0.4,  1.0,  2.0)};
+    bool divide[nCases] = {false, false, true, true};
+
+    for(int c=0; c<nCases; c++) {
+        IDistribution* r = x[c]->clone();
+        if(divide[c]) {
+            r->divide(y[c]);
+        } else {
+            r->multiply(y[c]);
+        }
+
+        vector<double> z = r->zSamples();
+        vector<double> F = r->cdf();
+        int nSamples = z.size();
+        double maxDiff = 0.0;
+        for(int i=0; i<nSamples; i++) {
+            double ref = referenceProductCdf(x[c], y[c], divide[c], z[i],
+                                             5000);
+            maxDiff = std::max(maxDiff, std::abs(F[i] - ref));
+        }
+        check(maxDiff < 1e-2, divide[c] ? "one-signed quotient cdf"
+                                        : "one-signed product cdf", maxDiff);
+        delete r;
+        delete x[c];
+        delete y[c];
+    }
+}
+
+// Products and quotients whose supports contain zero agree with a direct
+// integration of the cdf, also for uniforms, whose jumps keep the grid
+// method
+void testMixedSignProduct()
+{
+    const int nCases = 5;
+    IDistribution* x[nCases] = {peakOn(0.3, 0.5, -1.0, 1.0),
+                                peakOn(0.1, 0.6,  0.0, 1.0),
+                                peakOn(0.4, 0.7, -1.0, 1.0),
+                                new UniformDistribution(-1.0, 2.0),
+                                new UniformDistribution(-1.0, 2.0)};
+    IDistribution* y[nCases] = {peakOn(0.7, 0.8, -0.5, 2.0),
+                                peakOn(0.5, 0.3, -2.0, 1.0),
+                                peakOn(0.2, 0.5,  1.0, 3.0),
+                                new UniformDistribution(-0.5, 1.5),
+                                new UniformDistribution(0.5, 1.5)};
+    bool divide[nCases] = {false, false, true, false, true};
+
+    for(int c=0; c<nCases; c++) {
+        IDistribution* r = x[c]->clone();
+        if(divide[c]) {
+            r->divide(y[c]);
+        } else {
+            r->multiply(y[c]);
+        }
+
+        vector<double> z = r->zSamples();
+        vector<double> F = r->cdf();
+        int nSamples = z.size();
+        double maxDiff = 0.0;
+        for(int i=0; i<nSamples; i++) {
+            double ref = referenceProductCdf(x[c], y[c], divide[c], z[i],
+                                             5000);
+            maxDiff = std::max(maxDiff, std::abs(F[i] - ref));
+        }
+        check(maxDiff < 1e-2, divide[c] ? "mixed-sign quotient cdf"
+                                        : "mixed-sign product cdf", maxDiff);
+        delete r;
+        delete x[c];
+        delete y[c];
+    }
+}
+
+// Without a pool, a sampled distribution computes on its grid rather than
+// dropping the operation
+void testEmptyPoolArithmetic()
+{
+    SampledDistribution empty;
+    empty.defineBoundaries(0.0, 1.0);
+    UniformDistribution other(0.0, 1.0);
+    empty.add(&other);
+    empty.multiply(2.0);
+
+    check(empty.poolSize() == 0 && empty.upperBound() == 4.0,
+          "empty pool operations act on the grid", empty.upperBound());
+    check(std::abs(empty.mean() - 2.0) < 1e-3,
+          "empty pool sum keeps its mean", empty.mean());
+}
+
+// A zero in the divisor pool gives the unbounded grid quotient instead of
+// infinite samples, and a degenerate interval collapses the pool
+void testSampledDivisionByZero()
+{
+    vector<double> xs(100);
+    vector<double> ys(100);
+    for(int i=0; i<100; i++) {
+        xs[i] = 1.0 + 0.01*i;
+        ys[i] = 0.02*i;
+    }
+
+    SampledDistribution quotient(xs);
+    SampledDistribution divisor(ys);
+    quotient.divide(&divisor);
+    bool finite = std::isfinite(quotient.lowerBound()) &&
+                  std::isfinite(quotient.upperBound());
+    check(finite && quotient.poolSize() == 0,
+          "zero divisor sample continues on the grid",
+          quotient.upperBound());
+
+    SampledDistribution inverse(ys);
+    inverse.reciprocal();
+    finite = std::isfinite(inverse.lowerBound()) &&
+             std::isfinite(inverse.upperBound());
+    check(finite && inverse.poolSize() == 0,
+          "zero sample reciprocal continues on the grid",
+          inverse.upperBound());
+
+    SampledDistribution point(xs);
+    point.defineBoundaries(2.0, 2.0);
+    check(point.poolSize() == 100 && point.mean() == 2.0 &&
+          point.lowerBound() == 2.0,
+          "degenerate boundaries collapse the pool", point.mean());
+}
+
+// largest difference between the cdfs of two distributions on the grid of
+// the first
+double cdfDifference(IDistribution* a, IDistribution* b)
+{
+    vector<double> z = a->zSamples();
+    vector<double> F = a->cdf();
+    double maxDiff = 0.0;
+    for(int i=0; i<(int)z.size(); i++) {
+        maxDiff = std::max(maxDiff, std::abs(F[i] - b->cdf(z[i])));
+    }
+    return maxDiff;
+}
+
+// An expression gives the result of the same operations applied in turn,
+// with fused affine and sum chains, shared sub-expressions, a requested
+// number of samples and invalid divisions
+void testDistributionExpression()
+{
+    IDistribution* a = peakOn(0.3, 0.5, 1.0, 2.0);
+    IDistribution* b = peakOn(0.6, 0.7, 0.5, 1.5);
+
+    // (a*2 + 1)*3 is one affine remap
+    IDistribution* fused = (3.0*(DistributionExpression(a)*2.0 + 1.0))
+                           .evaluate();
+    IDistribution* stepwise = a->clone();
+    stepwise->affineTransform(6.0, 3.0);
+    double diff = cdfDifference(stepwise, fused);
+    check(diff < 1e-9 && !fused->isCDFDeferred(),
+          "fused affine chain matches the remap", diff);
+    delete fused;
+    delete stepwise;
+
+    // a*b + a/b
+    DistributionExpression ea(a);
+    DistributionExpression eb(b);
+    IDistribution* lazy = (ea*eb + ea/eb).evaluate();
+    IDistribution* product = a->clone();
+    product->multiply(b);
+    IDistribution* quotient = a->clone();
+    quotient->divide(b);
+    product->add(quotient);
+    diff = cdfDifference(product, lazy);
+    check(diff < 1e-6, "expression matches the eager operations", diff);
+    delete lazy;
+    delete product;
+    delete quotient;
+
+    // a shared sub-expression is evaluated once and copied
+    DistributionExpression sum = ea + eb;
+    IDistribution* twice = (sum + sum).evaluate();
+    IDistribution* eager = a->clone();
+    eager->add(b);
+    IDistribution* eagerCopy = eager->clone();
+    eager->add(eagerCopy);
+    diff = cdfDifference(eager, twice);
+    check(diff < 1e-6, "shared sub-expression matches", diff);
+    delete twice;
+    delete eager;
+    delete eagerCopy;
+
+    // a + b - a is a single convolution of three terms, on a finer grid
+    // than the pairwise sums
+    IDistribution* chain = (ea + eb - ea).evaluate();
+    IDistribution* pairwise = a->clone();
+    pairwise->add(b);
+    pairwise->subtract(a);
+    diff = cdfDifference(chain, pairwise);
+    check(diff < 1e-3 && std::abs(chain->mean() - b->mean()) < 1e-3,
+          "fused sum chain matches the pairwise sums", diff);
+    delete chain;
+    delete pairwise;
+
+    // the requested number of samples, and a normalised result
+    IDistribution* resampled = (ea*eb).evaluate(101);
+    IDistribution* full = (ea*eb).evaluate();
+    diff = cdfDifference(full, resampled);
+    check(resampled->zSamples().size() == 101 && diff < 1e-2 &&
+          !resampled->isCDFDeferred() && resampled->cdf().back() == 1.0,
+          "result is tabulated on the requested samples", diff);
+    check(std::abs(resampled->mean() - full->mean()) < 1e-2,
+          "resampled result keeps the mean", resampled->mean());
+    delete resampled;
+    delete full;
+
+    IDistribution* invalid = (ea/0.0 + eb).evaluate();
+    check(invalid == 0, "division by zero gives an invalid expression", 0.0);
+
+    delete a;
+    delete b;
+}
+
+} // namespace
+
+int main()
+{
+    testGuideTableSampling();
+    testPeakPDFKernel();
+    testPeakCacheHitRate();
+    testPeakCacheMemoryBound();
+    testPeakCacheQuantiseBounds();
+    testPeakCacheSharedSampling();
+    testMergedCompositionSampling();
+    testMergedCollapse();
+    testOneSignedProduct();
+    testMixedSignProduct();
+    testEmptyPoolArithmetic();
+    testSampledDivisionByZero();
+    testDistributionExpression();
+
+    printf("%d failed\n", nFailures);
+    return nFailures;
+}
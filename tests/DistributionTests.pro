@@ -0,0 +1,25 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+# RandomDistributions uses QtMath
+QT = core
+CONFIG += c++11
+# "make check" runs the target
+CONFIG += testcase
+
+TARGET = DistributionTests
+# the test programs share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+# RandomDistributions also needs the Tigon headers and boost, so the target
+# only builds inside the Liger tree
+
+SOURCES += DistributionTests.cpp \
+    ../core/RandomDistributions.cpp \
+    ../core/PeakDistributionCache.cpp \
+    ../core/DistributionExpression.cpp \
+    ../core/utils/AbstractInterpolator.cpp \
+    ../core/utils/LinearInterpolator.cpp \
+    ../core/utils/Convolution.cpp \
+    ../core/utils/RandomStream.cpp
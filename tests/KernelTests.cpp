@@ -0,0 +1,183 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Checks of the uncertainty kernel, and that the batch kernels give the
+// results of UncertaintyKernelView bit for bit (which needs
+// -ffp-contract=off). Each check prints a line and the program returns the
+// number of failed checks.
+#include <core/UncertaintyKernel.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace CODeM;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool passed, const char* name, double value)
+{
+    printf("%s %s (%g)\n", passed ? "PASS" : "FAIL", name, value);
+    if(!passed) {
+        nFailures++;
+    }
+}
+
+// The symmetry is 1 on the diagonal, 0 on an axis, 1 at the ideal point,
+// and never outside [0,1]
+void testSymmetryRange()
+{
+    const int nObjs = 4;
+    const int objs[nObjs] = {2, 3, 5, 10};
+
+    for(int o=0; o<nObjs; o++) {
+        int n = objs[o];
+        vector<double> ideal(n, 0.0);
+        vector<double> invRange(n, 1.0);
+
+        UncertaintyKernelView atIdeal(ideal, ideal, invRange, 0.0, 1.0);
+        check(atIdeal.symmetry() == 1.0, "symmetry at the ideal point is 1",
+              atIdeal.symmetry());
+
+        vector<double> axis(n, 0.0);
+        axis[n-1] = 0.4;
+        UncertaintyKernelView onAxis(axis, ideal, invRange, 0.0, 1.0);
+        check(onAxis.symmetry() == 0.0, "symmetry on an axis is 0",
+              onAxis.symmetry());
+
+        // on and around the diagonal, where rounding is largest
+        std::mt19937 gen(n);
+        std::uniform_real_distribution<double> uni(0.0, 1.0);
+        double lowest  = 1.0;
+        double highest = 0.0;
+        for(int t=0; t<10000; t++) {
+            vector<double> o(n, uni(gen));
+            if(t % 2 == 1) {
+                for(int i=0; i<n; i++) {
+                    o[i] = uni(gen);
+                }
+            }
+            UncertaintyKernelView uk(o, ideal, invRange, 0.0, 1.0);
+            lowest  = std::min(lowest, uk.symmetry());
+            highest = std::max(highest, uk.symmetry());
+        }
+        check(lowest >= 0.0 && highest <= 1.0, "symmetry is within [0,1]",
+              highest);
+    }
+}
+
+// Objective vectors of nInd individuals, row-major. The first rows are the
+// ideal point, a point on an axis, a point on the diagonal and a point
+// beyond the anti-ideal; the others are random, some below the ideal.
+vector<double> objectiveRows(int nInd, int nObj, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> uni(-0.2, 1.5);
+    vector<double> rows(nInd*nObj);
+    for(int j=0; j<nInd; j++) {
+        for(int m=0; m<nObj; m++) {
+            double v;
+            switch(j) {
+            case 0:  v = 0.0;                          break;
+            case 1:  v = (m == 0) ? 0.7 : 0.0;         break;
+            case 2:  v = 0.3*(m+1);                    break;
+            case 3:  v = 5.0*(m+1);                    break;
+            default: v = uni(gen)*(m+1);               break;
+            }
+            rows[j*nObj+m] = v;
+        }
+    }
+    return rows;
+}
+
+void testBatchMatchesView()
+{
+    const int nInd = 777;
+    const int nObjs = 3;
+    const int objs[nObjs] = {2, 3, 7};
+    // the last pair is invalid, and replaced by [0,1]
+    const int nBounds = 3;
+    const double bounds[nBounds][2] = {{0.0, 1.0}, {2.0/3.0, 1.0},
+                                       {0.9, 0.2}};
+
+    for(int o=0; o<nObjs; o++) {
+        int nObj = objs[o];
+        vector<double> rows = objectiveRows(nInd, nObj, nObj);
+        vector<double> ideal(nObj, 0.0);
+        vector<double> antiIdeal(nObj);
+        for(int m=0; m<nObj; m++) {
+            antiIdeal[m] = m+1.0;
+        }
+        vector<double> invRange;
+        inverseRanges(ideal, antiIdeal, invRange);
+
+        // the batch kernel takes the transposed matrix
+        vector<double> cols(nInd*nObj);
+        for(int j=0; j<nInd; j++) {
+            for(int m=0; m<nObj; m++) {
+                cols[m*nInd+j] = rows[j*nObj+m];
+            }
+        }
+
+        int nBatchDiff = 0;
+        int nRowsDiff  = 0;
+        for(int b=0; b<nBounds; b++) {
+            double lb = bounds[b][0];
+            double ub = bounds[b][1];
+
+            vector<double> prox(nInd), sym(nInd), dir(nInd*nObj);
+            uncertaintyKernelBatch(cols.data(), nInd, nObj, ideal.data(),
+                                   invRange.data(), lb, ub, prox.data(),
+                                   sym.data(), dir.data());
+            vector<double> rProx(nInd), rSym(nInd), rDir(nInd*nObj);
+            uncertaintyKernelRows(rows.data(), nInd, nObj, ideal.data(),
+                                  invRange.data(), lb, ub, rProx.data(),
+                                  rSym.data(), rDir.data());
+
+            vector<double> d(nObj);
+            for(int j=0; j<nInd; j++) {
+                vector<double> oVec(rows.begin()+j*nObj,
+                                    rows.begin()+(j+1)*nObj);
+                UncertaintyKernelView uk(oVec, ideal, invRange, lb, ub,
+                                         d.data());
+                nBatchDiff += (prox[j] != uk.proximity());
+                nBatchDiff += (sym[j]  != uk.symmetry());
+                nRowsDiff  += (rProx[j] != uk.proximity());
+                nRowsDiff  += (rSym[j]  != uk.symmetry());
+                for(int m=0; m<nObj; m++) {
+                    nBatchDiff += (dir[m*nInd+j]  != uk.direction()[m]);
+                    nRowsDiff  += (rDir[j*nObj+m] != uk.direction()[m]);
+                }
+            }
+        }
+        check(nBatchDiff == 0, "uncertaintyKernelBatch matches the view",
+              nBatchDiff);
+        check(nRowsDiff == 0, "uncertaintyKernelRows matches the view",
+              nRowsDiff);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testSymmetryRange();
+    testBatchMatchesView();
+
+    printf("%d failed\n", nFailures);
+    return nFailures;
+}
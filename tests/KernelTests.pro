@@ -0,0 +1,18 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+# "make check" runs the target
+CONFIG += testcase
+# bit identity needs unfused multiply-adds, as in CODeM.pro
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+TARGET = KernelTests
+# the test programs share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += KernelTests.cpp \
+    ../core/UncertaintyKernelView.cpp
@@ -0,0 +1,187 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Statistical checks of the CODeM operators, and a check of the Lp norm
+// kernel. The streams are seeded, so every run draws the same samples; the
+// bounds are those of a test at the 1% level. Each check prints a line and
+// the program returns the number of failed checks.
+#include <core/CODeMOperators.h>
+#include <core/utils/NormKernels.h>
+#include <core/utils/RandomStream.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace CODeM;
+using std::vector;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool passed, const char* name, double value)
+{
+    printf("%s %s (%g)\n", passed ? "PASS" : "FAIL", name, value);
+    if(!passed) {
+        nFailures++;
+    }
+}
+
+double pNorm(const double* x, int n, double p)
+{
+    double acc = 0.0;
+    for(int i=0; i<n; i++) {
+        double a = std::abs(x[i]);
+        acc = std::isinf(p) ? std::max(acc, a) : acc + std::pow(a, p);
+    }
+    return std::isinf(p) ? acc : std::pow(acc, 1.0/p);
+}
+
+// Points of uniformBallSamples() lie in the ball, their p-norm has the CDF
+// (r/R)^n of the uniform distribution (Kolmogorov-Smirnov), and the
+// distribution is unchanged by flipping signs and by permuting axes
+void testUniformBall()
+{
+    const int nSamp = 20000;
+    const double radius = 1.5;
+    const int nNorms = 4;
+    const double norms[nNorms] = {1.0, 2.0, 3.0,
+                                  std::numeric_limits<double>::infinity()};
+    const int nDims = 3;
+    const int dims[nDims] = {2, 3, 6};
+
+    // the 1% critical value of the KS statistic, and four standard errors
+    // of a fraction around 1/2
+    const double ksBound   = 1.63 / std::sqrt((double)nSamp);
+    const double fracBound = 4.0 * 0.5 / std::sqrt((double)nSamp);
+
+    for(int k=0; k<nNorms; k++) {
+        double p = norms[k];
+        for(int d=0; d<nDims; d++) {
+            int n = dims[d];
+            RandomStream stream(17, k*nDims + d);
+            vector<double> x((size_t)nSamp*n);
+            uniformBallSamples(x.data(), nSamp, n, radius, p, &stream);
+
+            // (r/R)^n is uniform in [0,1]
+            vector<double> u(nSamp);
+            double largest = 0.0;
+            for(int s=0; s<nSamp; s++) {
+                double r = pNorm(x.data() + (size_t)s*n, n, p) / radius;
+                largest = std::max(largest, r);
+                u[s] = std::pow(r, n);
+            }
+            std::sort(u.begin(), u.end());
+            double ks = 0.0;
+            for(int s=0; s<nSamp; s++) {
+                ks = std::max(ks, std::max((s+1.0)/nSamp - u[s],
+                                           u[s] - (double)s/nSamp));
+            }
+            check(largest <= 1.0 + 1e-12, "ball samples are inside the ball",
+                  largest);
+            check(ks <= ksBound, "ball radius has the CDF (r/R)^n", ks);
+
+            // each coordinate and each product of two neighbouring ones is
+            // positive half of the time
+            double worstFrac = 0.0;
+            for(int i=0; i<n; i++) {
+                int nPos  = 0;
+                int nSame = 0;
+                for(int s=0; s<nSamp; s++) {
+                    const double* xs = x.data() + (size_t)s*n;
+                    nPos  += (xs[i] > 0.0);
+                    nSame += (xs[i]*xs[(i+1) % n] > 0.0);
+                }
+                worstFrac = std::max(worstFrac,
+                                     std::abs((double)nPos/nSamp - 0.5));
+                worstFrac = std::max(worstFrac,
+                                     std::abs((double)nSame/nSamp - 0.5));
+            }
+            check(worstFrac <= fracBound, "ball samples are sign symmetric",
+                  worstFrac);
+
+            // every axis has the same mean |x_i|, within four standard
+            // errors of the mean over the axes
+            vector<double> meanAbs(n, 0.0);
+            vector<double> meanSq(n, 0.0);
+            for(int s=0; s<nSamp; s++) {
+                for(int i=0; i<n; i++) {
+                    double a = std::abs(x[(size_t)s*n + i]);
+                    meanAbs[i] += a / nSamp;
+                    meanSq[i]  += a*a / nSamp;
+                }
+            }
+            double overall = 0.0;
+            double var     = 0.0;
+            for(int i=0; i<n; i++) {
+                overall += meanAbs[i] / n;
+                var     += (meanSq[i] - meanAbs[i]*meanAbs[i]) / n;
+            }
+            double axisBound = 4.0 * std::sqrt(var / nSamp);
+            double worstAxis = 0.0;
+            for(int i=0; i<n; i++) {
+                worstAxis = std::max(worstAxis,
+                                     std::abs(meanAbs[i] - overall));
+            }
+            check(worstAxis <= axisBound, "ball samples are axis symmetric",
+                  worstAxis / axisBound);
+        }
+    }
+}
+
+// The blocked exp(p*log|x|) form of pNorm<LpNorm>() agrees with a pow
+// reduction within |p*log|x|| + 1 ulp per term, over several blocks and
+// with zeros, and the dispatched pNorm() gives the same value
+void testLpNorm()
+{
+    const int n = 3*LpNormBlockSize + 5;
+    const int nNorms = 4;
+    const double norms[nNorms] = {0.5, 1.5, 3.3, 12.0};
+    RandomStream stream(23, 0);
+    vector<double> x(n);
+    stream.fillUniform(x.data(), n);
+    for(int i=0; i<n; i++) {
+        x[i] = (i % 7 == 0) ? 0.0 : 4.0*x[i] - 2.0;
+    }
+
+    double worst = 0.0;
+    bool dispatched = true;
+    for(int k=0; k<nNorms; k++) {
+        double p = norms[k];
+        double ref = pNorm(x.data(), n, p);
+        double lp  = CODeM::pNorm<LpNorm>(x.data(), n, p);
+        worst = std::max(worst, std::abs(lp - ref) / ref);
+        dispatched = dispatched &&
+                (CODeM::pNorm(x.data(), n, LpNorm, p) == lp);
+    }
+    // the terms with a large |p*log|x||, those of small |x|, add little to
+    // the sum
+    check(worst <= 64.0*std::numeric_limits<double>::epsilon(),
+          "blocked Lp norm matches pow", worst);
+    check(dispatched, "dispatched Lp norm matches the template", worst);
+}
+
+} // namespace
+
+int main()
+{
+    testUniformBall();
+    testLpNorm();
+
+    printf("%d failed\n", nFailures);
+    return nFailures;
+}
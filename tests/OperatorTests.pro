@@ -0,0 +1,18 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+# "make check" runs the target
+CONFIG += testcase
+
+TARGET = OperatorTests
+# the test programs share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += OperatorTests.cpp \
+    ../core/CODeMOperators.cpp \
+    ../core/utils/NormKernels.cpp \
+    ../core/utils/RandomStream.cpp
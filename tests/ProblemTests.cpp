@@ -0,0 +1,211 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Checks of the CODeM problems and of the population evaluator. Each check
+// prints a line and the program returns the number of failed checks.
+#include <core/CODeMProblems.h>
+#include <core/CODeMDistribution.h>
+#include <core/utils/RandomStream.h>
+#include <core/utils/ThreadPool.h>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace CODeM;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool passed, const char* name, double value)
+{
+    printf("%s %s (%g)\n", passed ? "PASS" : "FAIL", name, value);
+    if(!passed) {
+        nFailures++;
+    }
+}
+
+const int NVar = 10;
+const int K    = 4;
+const int NObj = 3;
+
+// nInd decision vectors inside the box constraints of problem prob,
+// row-major
+vector<double> population(int prob, int nInd, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    vector<double> X(nInd*NVar);
+    for(int i=0; i<nInd; i++) {
+        for(int j=0; j<NVar; j++) {
+            double ub = (prob == 6) ? 1.0 : 2.0*(j+1.0);
+            X[i*NVar+j] = ub * uni(gen);
+        }
+    }
+    return X;
+}
+
+// The output of evaluatePopulation() is bit-identical for any number of
+// threads
+void testPopulationThreadCounts()
+{
+    const int nInd  = 37;
+    const int nSamp = 5;
+    const int nPools = 4;
+    const int poolSizes[nPools] = {1, 2, 3, 8};
+    const size_t nOut = (size_t)nInd*nSamp*NObj;
+
+    for(int prob=1; prob<=6; prob++) {
+        vector<double> X = population(prob, nInd, prob);
+
+        ThreadPool serial(1);
+        vector<double> ref(nOut);
+        bool ok = evaluatePopulation(prob, X.data(), nInd, NVar, K, NObj,
+                                     nSamp, ref.data(), 11, &serial);
+
+        int nDiff = 0;
+        for(int p=1; p<nPools; p++) {
+            ThreadPool pool(poolSizes[p]);
+            vector<double> out(nOut);
+            ok = evaluatePopulation(prob, X.data(), nInd, NVar, K, NObj,
+                                    nSamp, out.data(), 11, &pool) && ok;
+            nDiff += (memcmp(out.data(), ref.data(),
+                             nOut*sizeof(double)) != 0);
+        }
+        check(ok, "every individual of the population is evaluated", prob);
+        check(nDiff == 0, "population output is independent of the "
+                          "thread count", prob);
+    }
+}
+
+// CODeMxPerturb with an explicit stream
+void freePerturb(int prob, const vector<double>& iVec,
+                 const vector<double>& oVec, int nSamp, double* samples,
+                 RandomStream* stream)
+{
+    switch(prob) {
+    case 1:
+        CODeM1Perturb(oVec, nSamp, samples, stream);
+        break;
+    case 2:
+        CODeM2Perturb(oVec, nSamp, samples, stream);
+        break;
+    case 3:
+        CODeM3Perturb(oVec, nSamp, samples, stream);
+        break;
+    case 4:
+        CODeM4Perturb(oVec, nSamp, samples, stream);
+        break;
+    case 5:
+        CODeM5Perturb(iVec, oVec, nSamp, samples, stream);
+        break;
+    default:
+        CODeM6Perturb(iVec, oVec, nSamp, samples, stream);
+        break;
+    }
+}
+
+// The problem objects give the samples of the free functions, bit for bit,
+// from streams at the same position
+void testProblemMatchesFreeFunctions()
+{
+    const int nInd  = 10;
+    const int nSamp = 8;
+
+    for(int prob=1; prob<=6; prob++) {
+        CODeMProblem* problem = createCODeMProblem(prob, NVar, K, NObj);
+        vector<double> X = population(prob, nInd, 50+prob);
+
+        int nDiff = 0;
+        bool ok = true;
+        for(int i=0; i<nInd; i++) {
+            vector<double> iVec(X.begin()+i*NVar, X.begin()+(i+1)*NVar);
+            vector<double> oVec = deterministicOVec(prob, iVec, NObj, K);
+
+            vector<double> ref(nSamp*NObj);
+            RandomStream refStream(3, i);
+            freePerturb(prob, iVec, oVec, nSamp, ref.data(), &refStream);
+
+            vector<double> perturbed(nSamp*NObj);
+            RandomStream perturbStream(3, i);
+            ok = problem->perturb(iVec, oVec, nSamp, perturbed.data(),
+                                  &perturbStream) && ok;
+
+            vector<double> evaluated(nSamp*NObj);
+            RandomStream evaluateStream(3, i);
+            ok = problem->evaluate(iVec, nSamp, evaluated.data(),
+                                   &evaluateStream) && ok;
+
+            nDiff += (perturbed != ref) + (evaluated != ref);
+            nDiff += (problem->evaluate(iVec) != oVec);
+        }
+        check(ok, "CODeMProblem evaluates every vector", prob);
+        check(nDiff == 0, "CODeMProblem matches the free functions", prob);
+
+        // an objective vector of the wrong size is reported
+        vector<double> iVec(X.begin(), X.begin()+NVar);
+        vector<double> shortOVec(NObj-1, 0.5);
+        vector<double> untouched(nSamp*NObj, -1.0);
+        bool rejected = !problem->perturb(iVec, shortOVec, nSamp,
+                                          untouched.data());
+        rejected = rejected && untouched == vector<double>(nSamp*NObj, -1.0);
+        check(rejected, "a wrong-sized objective vector is rejected", prob);
+
+        delete problem;
+    }
+}
+
+// A CODeMDistribution reused from one individual to the next, and from one
+// problem to another, gives the samples of a new one, bit for bit
+void testReusedDistribution()
+{
+    const int nInd  = 6;
+    const int nSamp = 8;
+
+    CODeMDistribution reused;
+    for(int prob=1; prob<=6; prob++) {
+        CODeMProblem* problem = createCODeMProblem(prob, NVar, K, NObj);
+        vector<double> X = population(prob, nInd, 70+prob);
+
+        int nDiff = 0;
+        for(int i=0; i<nInd; i++) {
+            vector<double> iVec(X.begin()+i*NVar, X.begin()+(i+1)*NVar);
+
+            vector<double> ref(nSamp*NObj);
+            RandomStream refStream(5, i);
+            problem->evaluate(iVec, nSamp, ref.data(), &refStream);
+
+            vector<double> out(nSamp*NObj);
+            RandomStream stream(5, i);
+            problem->evaluate(iVec, nSamp, out.data(), &stream, reused);
+            nDiff += (out != ref);
+        }
+        check(nDiff == 0, "a reused distribution matches a new one", prob);
+
+        delete problem;
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testPopulationThreadCounts();
+    testProblemMatchesFreeFunctions();
+    testReusedDistribution();
+
+    printf("%d failed\n", nFailures);
+    return nFailures;
+}
@@ -0,0 +1,37 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+# "make check" runs the target
+CONFIG += testcase
+
+TARGET = ProblemTests
+# the test programs share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += ProblemTests.cpp \
+    ../core/RandomDistributions.cpp \
+    ../core/CODeMDistribution.cpp \
+    ../core/CODeMOperators.cpp \
+    ../core/CODeMProblems.cpp \
+    ../core/UncertaintyKernel.cpp \
+    ../core/UncertaintyKernelView.cpp \
+    ../core/PeakDistributionCache.cpp \
+    ../core/DistributionExpression.cpp \
+    ../core/utils/AbstractInterpolator.cpp \
+    ../core/utils/LinearInterpolator.cpp \
+    ../core/utils/Convolution.cpp \
+    ../core/utils/NormKernels.cpp \
+    ../core/utils/RandomStream.cpp \
+    ../core/utils/ThreadPool.cpp \
+    ../libs/DTLZ/DTLZProblems.cpp \
+    ../libs/WFG/ExampleProblems.cpp \
+    ../libs/WFG/ExampleShapes.cpp \
+    ../libs/WFG/ExampleTransitions.cpp \
+    ../libs/WFG/FrameworkFunctions.cpp \
+    ../libs/WFG/Misc.cpp \
+    ../libs/WFG/ShapeFunctions.cpp \
+    ../libs/WFG/TransFunctions.cpp
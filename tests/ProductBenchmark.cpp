@@ -0,0 +1,271 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Time and accuracy of products and quotients of distributions, for the
+// log-domain and strip methods of IDistribution and for the quadratic
+// double loop they replaced. Each case is run over a sweep of sample
+// counts n, used both for the output grid and for the log grid. Prints the
+// best time of several runs and the largest cdf error against a direct
+// integration, at ProbeNPoints points across the result, and the method
+// multiply() and divide() use for the case at that n.
+#include <core/RandomDistributions.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace CODeM;
+
+namespace {
+
+const int BenchRuns         = 7;
+const int ReferenceNSamples = 20000;
+const int ProbeNPoints      = 201;
+const int NSweep            = 4;
+const int Sweep[NSweep]     = {250, 500, 1000, 2000};
+
+// Exposes the product kernels with the sample counts as arguments
+class SweepDistribution : public IDistribution
+{
+public:
+    SweepDistribution(const IDistribution& d) : IDistribution(d) {}
+
+    void combine(const IDistribution* other, bool divide, int n)
+    {
+        bool oneSigned = (m_lb > 0.0 || m_ub < 0.0) &&
+                (other->lowerBound() > 0.0 || other->upperBound() < 0.0);
+        if(oneSigned) {
+            logDomainMultiply(other, divide, n, n);
+        } else {
+            mixedSignMultiply(other, divide, n, n);
+        }
+    }
+
+    // the method multiply() and divide() take at this n
+    const char* method(const IDistribution* other, int n)
+    {
+        bool oneSigned = (m_lb > 0.0 || m_ub < 0.0) &&
+                (other->lowerBound() > 0.0 || other->upperBound() < 0.0);
+        if(oneSigned) {
+            return "log";
+        }
+        return useStripIntegration(other, n) ? "strip" : "grid";
+    }
+};
+
+// A tabulated result of the quadratic method
+struct Table
+{
+    vector<double> z;
+    vector<double> cdf;
+};
+
+// The product and quotient of IDistribution before the log-domain method:
+// every output point sums the joint density over n points of one operand
+Table quadraticProduct(IDistribution* x, IDistribution* y, bool divide,
+                       int n)
+{
+    double lbT = x->lowerBound();
+    double ubT = x->upperBound();
+    double lbO = y->lowerBound();
+    double ubO = y->upperBound();
+    double lb, ub;
+    if(divide) {
+        lb = std::min(std::min(lbT/lbO, lbT/ubO), std::min(ubT/lbO, ubT/ubO));
+        ub = std::max(std::max(lbT/lbO, lbT/ubO), std::max(ubT/lbO, ubT/ubO));
+    } else {
+        lb = std::min(std::min(lbT*lbO, lbT*ubO), std::min(ubT*lbO, ubT*ubO));
+        ub = std::max(std::max(lbT*lbO, lbT*ubO), std::max(ubT*lbO, ubT*ubO));
+    }
+
+    double dz  = (ub-lb) / (n-1);
+    double dzT = (ubT-lbT) / (n-1);
+    double dzO = (ubO-lbO) / (n-1);
+    Table t;
+    t.z.resize(n);
+    for(int i=0; i<n; i++) {
+        t.z[i] = (i == n-1) ? ub : lb + i*dz;
+    }
+
+    vector<double> pdf(n, 0.0);
+    for(int i=0; i<n; i++) {
+        for(int j=0; j<n; j++) {
+            if(divide) {
+                double zo = (j == n-1) ? ubO : lbO + j*dzO;
+                double zt = t.z[i]*zo;
+                if(zt >= lbT && zt <= ubT) {
+                    pdf[i] += y->pdf(zo) * x->pdf(zt) * std::abs(zo);
+                }
+                continue;
+            }
+            double zt = (j == n-1) ? ubT : lbT + j*dzT;
+            if(std::abs(zt) >= dzT/2) {
+                double zo = t.z[i]/zt;
+                if(zo >= lbO && zo <= ubO) {
+                    pdf[i] += x->pdf(zt) * y->pdf(zo) / std::abs(zt);
+                }
+            } else {
+                for(int side=-1; side<=1; side+=2) {
+                    zt = side*dzT/2;
+                    double zo = t.z[i]/zt;
+                    if(zo >= lbO && zo <= ubO) {
+                        pdf[i] += x->pdf(zt) * y->pdf(zo)
+                                / std::abs(zt) / 2.0;
+                    }
+                }
+            }
+        }
+        pdf[i] *= divide ? dzO : dzT;
+    }
+
+    t.cdf.assign(n, 0.0);
+    for(int i=0; i<n-1; i++) {
+        t.cdf[i+1] = t.cdf[i] + (pdf[i]+pdf[i+1])/2 * (t.z[i+1]-t.z[i]);
+    }
+    double area = t.cdf[n-1];
+    for(int i=0; i<n; i++) {
+        t.cdf[i] /= area;
+    }
+    return t;
+}
+
+double tableCdf(const Table& t, double z)
+{
+    if(z <= t.z.front()) {
+        return 0.0;
+    }
+    if(z >= t.z.back()) {
+        return 1.0;
+    }
+    int k = std::upper_bound(t.z.begin(), t.z.end(), z) - t.z.begin() - 1;
+    double w = (z - t.z[k]) / (t.z[k+1] - t.z[k]);
+    return t.cdf[k] + w*(t.cdf[k+1] - t.cdf[k]);
+}
+
+double referenceCdf(IDistribution* x, IDistribution* y, bool divide, double z)
+{
+    IDistribution* d = divide ? y : x;
+    IDistribution* e = divide ? x : y;
+    double a = d->lowerBound();
+    double h = (d->upperBound() - a) / ReferenceNSamples;
+    double F = 0.0;
+    for(int i=0; i<ReferenceNSamples; i++) {
+        double v = a + (i+0.5)*h;
+        double p = d->pdf(v) * h;
+        double c = divide ? e->cdf(z*v) : e->cdf(z/v);
+        F += (v > 0.0) ? p*c : p*(1.0-c);
+    }
+    return F;
+}
+
+IDistribution* peakOn(double tendency, double locality, double lb, double ub)
+{
+    PeakDistribution* d = new PeakDistribution(tendency, locality);
+    d->pdf();
+    d->affineTransform(ub-lb, lb);
+    return d;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+}
+
+void run(const char* name, IDistribution* x, IDistribution* y, bool divide)
+{
+    // the probe points and the reference cdf do not depend on n
+    SweepDistribution range(*x);
+    range.combine(y, divide, Sweep[0]);
+    double lb = range.lowerBound();
+    double ub = range.upperBound();
+    vector<double> probe(ProbeNPoints);
+    vector<double> ref(ProbeNPoints);
+    for(int i=0; i<ProbeNPoints; i++) {
+        probe[i] = lb + (ub-lb)*i/(ProbeNPoints-1);
+        ref[i]   = referenceCdf(x, y, divide, probe[i]);
+    }
+
+    for(int s=0; s<NSweep; s++) {
+        int n = Sweep[s];
+        double bestNew = 1e300;
+        double bestOld = 1e300;
+        SweepDistribution* r = 0;
+        Table old;
+        for(int k=0; k<BenchRuns; k++) {
+            delete r;
+            r = new SweepDistribution(*x);
+            auto start = std::chrono::steady_clock::now();
+            r->combine(y, divide, n);
+            bestNew = std::min(bestNew, elapsedMs(start));
+
+            start = std::chrono::steady_clock::now();
+            old = quadraticProduct(x, y, divide, n);
+            bestOld = std::min(bestOld, elapsedMs(start));
+        }
+
+        double errNew = 0.0;
+        double errOld = 0.0;
+        for(int i=0; i<ProbeNPoints; i++) {
+            errNew = std::max(errNew, std::abs(r->cdf(probe[i]) - ref[i]));
+            errOld = std::max(errOld, std::abs(tableCdf(old, probe[i])
+                                               - ref[i]));
+        }
+        SweepDistribution m(*x);
+        printf("%-22s %5d %9.3f %9.3f   %.2e  %.2e  %s\n",
+               name, n, bestNew, bestOld, errNew, errOld, m.method(y, n));
+        delete r;
+    }
+
+    delete x;
+    delete y;
+}
+
+} // namespace
+
+int main()
+{
+    printf("%-22s %5s %9s %9s   %-8s  %-8s  %s\n", "case", "n",
+           "new (ms)", "old (ms)", "new err", "old err", "used");
+
+    // one-signed: log-domain convolution
+    run("P[1,2]*P[0.5,3]",     peakOn(0.3, 0.5,  1.0,  2.0),
+                               peakOn(0.7, 0.8,  0.5,  3.0), false);
+    run("P[-2,-1]*P[1,3]",     peakOn(0.6, 0.4, -2.0, -1.0),
+                               peakOn(0.2, 0.7,  1.0,  3.0), false);
+    run("P[1,2]/P[0.5,1.5]",   peakOn(0.4, 0.6,  1.0,  2.0),
+                               peakOn(0.5, 0.5,  0.5,  1.5), true);
+    run("P[-3,-1]/P[1,2]",     peakOn(0.8, 0.9, -3.0, -1.0),
+                               peakOn(0.3, 0.4,  1.0,  2.0), true);
+    run("U[1,2]*U[1,3]",       new UniformDistribution(1.0, 2.0),
+                               new UniformDistribution(1.0, 3.0), false);
+    run("U[1,2]/U[1,3]",       new UniformDistribution(1.0, 2.0),
+                               new UniformDistribution(1.0, 3.0), true);
+
+    // supports containing zero: pieces and strips
+    run("P[-1,1]*P[-0.5,2]",   peakOn(0.3, 0.5, -1.0,  1.0),
+                               peakOn(0.7, 0.8, -0.5,  2.0), false);
+    run("P[0,1]*P[-2,1]",      peakOn(0.1, 0.6,  0.0,  1.0),
+                               peakOn(0.5, 0.3, -2.0,  1.0), false);
+    run("P[-1,1]/P[1,3]",      peakOn(0.4, 0.7, -1.0,  1.0),
+                               peakOn(0.2, 0.5,  1.0,  3.0), true);
+    run("P[-3,1]/P[-2,-0.5]",  peakOn(0.6, 0.9, -3.0,  1.0),
+                               peakOn(0.5, 0.5, -2.0, -0.5), true);
+    run("U[-1,2]*U[-0.5,1.5]", new UniformDistribution(-1.0, 2.0),
+                               new UniformDistribution(-0.5, 1.5), false);
+    run("U[-1,2]/U[0.5,1.5]",  new UniformDistribution(-1.0, 2.0),
+                               new UniformDistribution(0.5, 1.5), true);
+    return 0;
+}
@@ -0,0 +1,22 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+# RandomDistributions uses QtMath
+QT = core
+CONFIG += c++11
+
+TARGET = ProductBenchmark
+# the benchmarks share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+# RandomDistributions also needs the Tigon headers and boost, so the target
+# only builds inside the Liger tree
+
+SOURCES += ProductBenchmark.cpp \
+    ../core/RandomDistributions.cpp \
+    ../core/PeakDistributionCache.cpp \
+    ../core/utils/AbstractInterpolator.cpp \
+    ../core/utils/LinearInterpolator.cpp \
+    ../core/utils/Convolution.cpp \
+    ../core/utils/RandomStream.cpp
@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Time of the r_nonsep numerator over the group length n and the window A,
+// for r_nonsep_numerator() and for the nested window sum of the original
+// toolkit. Only A = n with n >= r_nonsep_sort_size takes the sorted form;
+// the other rows time the same loop twice. Prints the best of several runs
+// per call and the relative difference between the two numerators.
+#include <libs/WFG/InlineTransFunctions.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace WFGT::Toolkit;
+using std::vector;
+
+namespace {
+
+const int BenchRuns = 7;
+// about this many window terms per run, so every row takes similar time
+const double TermsPerRun = 2e7;
+
+volatile double sink = 0.0;
+
+double nestedNumerator(const double* y, int len, int A)
+{
+    double numerator = 0.0;
+    for(int j=0; j<len; j++) {
+        numerator += y[j];
+        for(int k=0; k<=A-2; k++) {
+            numerator += std::fabs(y[j] - y[(j+k+1) % len]);
+        }
+    }
+    return numerator;
+}
+
+// best time per call, in microseconds
+template<typename Body>
+double timeCall(Body body, int calls)
+{
+    double best = 1e300;
+    for(int k=0; k<BenchRuns; k++) {
+        auto start = std::chrono::steady_clock::now();
+        for(int c=0; c<calls; c++) {
+            sink = sink + body();
+        }
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(
+                                  stop-start).count() / calls);
+    }
+    return best;
+}
+
+} // namespace
+
+int main()
+{
+    const int nLengths = 7;
+    const int lengths[nLengths] = {16, 31, 32, 64, 256, 1000, 4000};
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    printf("%6s %6s %12s %12s %10s %8s\n",
+           "n", "A", "nested (us)", "new (us)", "rel diff", "form");
+    for(int l=0; l<nLengths; l++) {
+        int n = lengths[l];
+        vector<double> y(n);
+        vector<double> sorted(n);
+        for(int i=0; i<n; i++) {
+            y[i] = uni(gen);
+        }
+
+        // A must divide n
+        const int nWindows = 3;
+        const int windows[nWindows] = {1, n/2, n};
+        for(int w=0; w<nWindows; w++) {
+            int A = windows[w];
+            if(n % A != 0 || (w > 0 && A == windows[w-1])) {
+                continue;
+            }
+            int calls = std::max(1, (int)(TermsPerRun / ((double)n*A)));
+
+            double tNested = timeCall([&]() {
+                return nestedNumerator(y.data(), n, A);
+            }, calls);
+            double tNew = timeCall([&]() {
+                return InlineTransFunctions::r_nonsep_numerator(
+                            y.data(), n, A, sorted.data());
+            }, calls);
+
+            double ref = nestedNumerator(y.data(), n, A);
+            double num = InlineTransFunctions::r_nonsep_numerator(
+                        y.data(), n, A, sorted.data());
+            bool isSorted = (A == n &&
+                             n >= InlineTransFunctions::r_nonsep_sort_size);
+            printf("%6d %6d %12.3f %12.3f %10.1e %8s\n", n, A, tNested, tNew,
+                   std::fabs(num - ref) / ref, isSorted ? "sorted" : "nested");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Throughput of the random streams, in millions of variates per second,
+// with the AVX2 and the scalar Philox kernels. std::mt19937_64 is timed as
+// a reference. Prints the best of several runs.
+#include <core/utils/RandomStream.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace CODeM;
+using std::vector;
+
+namespace {
+
+const int BenchRuns = 7;
+const int NDraws    = 1 << 22;
+const int BatchSize = 1024;
+
+volatile double sink = 0.0;
+
+// best rate of body(), which draws NDraws variates, in M/s
+template<typename Body>
+double rate(Body body)
+{
+    double best = 1e300;
+    for(int k=0; k<BenchRuns; k++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best,
+                        std::chrono::duration<double>(stop-start).count());
+    }
+    return NDraws / best / 1e6;
+}
+
+void runStream(const char* kernel)
+{
+    RandomStream stream(1, 0);
+    vector<double> buffer(BatchSize);
+
+    double uni = rate([&]() {
+        double s = 0.0;
+        for(int i=0; i<NDraws; i++) {
+            s += stream.randUni();
+        }
+        sink = s;
+    });
+    double fillUni = rate([&]() {
+        for(int i=0; i<NDraws; i+=BatchSize) {
+            stream.fillUniform(buffer.data(), BatchSize);
+        }
+        sink = buffer[0];
+    });
+    double fillNorm = rate([&]() {
+        for(int i=0; i<NDraws; i+=BatchSize) {
+            stream.fillNormal(buffer.data(), BatchSize);
+        }
+        sink = buffer[0];
+    });
+    double words = rate([&]() {
+        uint64_t s = 0;
+        for(int i=0; i<NDraws; i++) {
+            s += stream.randUInt64();
+        }
+        sink = (double)s;
+    });
+
+    printf("%-10s %12.1f %12.1f %12.1f %12.1f\n",
+           kernel, uni, fillUni, fillNorm, words);
+}
+
+} // namespace
+
+int main()
+{
+    printf("%-10s %12s %12s %12s %12s\n", "kernel",
+           "randUni", "fillUniform", "fillNormal", "randUInt64");
+
+    if(defineVectorGeneration(true)) {
+        runStream("avx2");
+    } else {
+        printf("%-10s not supported by this CPU\n", "avx2");
+    }
+    defineVectorGeneration(false);
+    runStream("scalar");
+    defineVectorGeneration(true);
+
+    std::mt19937_64 gen(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    double uni = rate([&]() {
+        double s = 0.0;
+        for(int i=0; i<NDraws; i++) {
+            s += uniform(gen);
+        }
+        sink = s;
+    });
+    double norm = rate([&]() {
+        double s = 0.0;
+        for(int i=0; i<NDraws; i++) {
+            s += normal(gen);
+        }
+        sink = s;
+    });
+    printf("%-10s %12.1f %12s %12.1f %12s\n", "mt19937_64", uni, "-", norm,
+           "-");
+    return 0;
+}
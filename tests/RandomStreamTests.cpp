@@ -0,0 +1,164 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Checks of the Philox random streams. Each check prints a line and the
+// program returns the number of failed checks.
+#include <core/utils/RandomStream.h>
+#include <cstdio>
+#include <vector>
+
+using namespace CODeM;
+using std::vector;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool passed, const char* name, double value)
+{
+    printf("%s %s (%g)\n", passed ? "PASS" : "FAIL", name, value);
+    if(!passed) {
+        nFailures++;
+    }
+}
+
+// Known-answer vectors of Philox4x32-10 from the Random123 distribution:
+// the counter words, the key words and the output block
+const int      NKnownAnswers = 3;
+const uint32_t KnownAnswers[NKnownAnswers][10] = {
+    {0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x00000000, 0x00000000,
+     0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+    {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+     0xffffffff, 0xffffffff,
+     0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+    {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344,
+     0xa4093822, 0x299f31d0,
+     0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}
+};
+
+// The block counter is the low half of the Philox counter, the stream id
+// the high half and the seed the key
+void testKnownAnswers()
+{
+    for(int v=0; v<NKnownAnswers; v++) {
+        const uint32_t* kat = KnownAnswers[v];
+        uint64_t block    = ((uint64_t)kat[1] << 32) | kat[0];
+        uint64_t streamId = ((uint64_t)kat[3] << 32) | kat[2];
+        uint64_t seed     = ((uint64_t)kat[5] << 32) | kat[4];
+
+        RandomStream stream(seed, streamId);
+        stream.skipTo(block);
+        bool same = true;
+        for(int j=0; j<4; j++) {
+            same = same && stream.randUInt32() == kat[6+j];
+        }
+        check(same, "Philox4x32-10 known answer", v);
+    }
+}
+
+// The bulk path (AVX2 where the CPU has it) gives the uniforms of the
+// scalar generator, whatever the buffer position it starts from
+void testBulkMatchesScalar()
+{
+    const int nDraws = 4099;
+    const double twoPow53Inv = 1.0 / 9007199254740992.0;
+    const int nOffsets = 3;
+    const int offsets[nOffsets] = {0, 1, 3};
+
+    for(int o=0; o<nOffsets; o++) {
+        RandomStream bulk(12345, 7);
+        RandomStream scalar(12345, 7);
+        for(int i=0; i<offsets[o]; i++) {
+            bulk.randUInt64();
+            scalar.randUInt64();
+        }
+
+        vector<double> u(nDraws);
+        bulk.fillUniform(u.data(), nDraws);
+        int nDiff = 0;
+        for(int i=0; i<nDraws; i++) {
+            double s = (scalar.randUInt64() >> 11) * twoPow53Inv;
+            nDiff += (u[i] != s);
+        }
+        check(nDiff == 0, "bulk uniforms match the scalar generator", nDiff);
+    }
+
+    // randUni() draws from the same buffer
+    RandomStream buffered(99, 1);
+    RandomStream filled(99, 1);
+    vector<double> u(1000);
+    filled.fillUniform(u.data(), 1000);
+    int nDiff = 0;
+    for(int i=0; i<1000; i++) {
+        nDiff += (buffered.randUni() != u[i]);
+    }
+    check(nDiff == 0, "randUni matches fillUniform", nDiff);
+}
+
+// Forcing the scalar kernel does not change the numbers
+void testVectorGenerationSwitch()
+{
+    const int nDraws = 2048;
+    vector<double> vec(nDraws);
+    vector<double> sca(nDraws);
+    defineVectorGeneration(true);
+    RandomStream a(5, 3);
+    a.fillUniform(vec.data(), nDraws);
+    defineVectorGeneration(false);
+    RandomStream b(5, 3);
+    b.fillUniform(sca.data(), nDraws);
+    defineVectorGeneration(true);
+
+    int nDiff = 0;
+    for(int i=0; i<nDraws; i++) {
+        nDiff += (vec[i] != sca[i]);
+    }
+    check(nDiff == 0, "vector and scalar kernels agree", nDiff);
+}
+
+// Streams are pure functions of (seed, streamId, position)
+void testStreamIndependence()
+{
+    RandomStream a(1, 0);
+    RandomStream b(1, 1);
+    RandomStream c(1, 0);
+    int nSame = 0;
+    int nRepeat = 0;
+    for(int i=0; i<1000; i++) {
+        double x = a.randUni();
+        nSame   += (x == b.randUni());
+        nRepeat += (x == c.randUni());
+    }
+    check(nSame == 0, "stream ids give different sequences", nSame);
+    check(nRepeat == 1000, "a stream repeats from its definition", nRepeat);
+
+    a.skipTo(0);
+    RandomStream d(1, 0);
+    check(a.randUInt64() == d.randUInt64(), "skipTo restarts the stream", 0);
+}
+
+} // namespace
+
+int main()
+{
+    testKnownAnswers();
+    testBulkMatchesScalar();
+    testVectorGenerationSwitch();
+    testStreamIndependence();
+
+    printf("%d failed\n", nFailures);
+    return nFailures;
+}
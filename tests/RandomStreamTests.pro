@@ -0,0 +1,16 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+# "make check" runs the target
+CONFIG += testcase
+
+TARGET = RandomStreamTests
+# the test programs share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += RandomStreamTests.cpp \
+    ../core/utils/RandomStream.cpp
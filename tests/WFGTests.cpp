@@ -0,0 +1,272 @@
+/****************************************************************************
+**
+** Copyright (C) 2012-2015 The University of Sheffield (www.sheffield.ac.uk)
+**
+** This file is part of Liger.
+**
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General
+** Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+****************************************************************************/
+// Checks that the batch (BatchProblems.h) and composed (ComposedProblems.h)
+// versions of WFG1-9 and I1-I5 give the objectives of ExampleProblems.h bit
+// for bit, except where they sort the large r_nonsep groups or keep running
+// sums of the following values for b_param, and that the sorted form of the
+// r_nonsep numerator agrees with the nested sum. Needs
+// -ffp-contract=off. Each check prints a line and the program returns the
+// number of failed checks.
+#include <libs/WFG/ExampleProblems.h>
+#include <libs/WFG/BatchProblems.h>
+#include <libs/WFG/ComposedProblems.h>
+#include <libs/WFG/TransFunctions.h>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace WFGT::Toolkit;
+using std::vector;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool passed, const char* name, double value)
+{
+    printf("%s %s (%g)\n", passed ? "PASS" : "FAIL", name, value);
+    if(!passed) {
+        nFailures++;
+    }
+}
+
+typedef vector<double> (*ScalarProblem)(const vector<double>&, int, int);
+typedef void (*BatchProblem)(const double*, int, int, int, int, double*,
+                             double*);
+typedef vector<double> (*ComposedProblem)(const vector<double>&, int, int);
+
+struct Problem
+{
+    const char*     name;
+    ScalarProblem   scalar;
+    BatchProblem    batch;
+    ComposedProblem composed;
+    // the WFG problems take z_i in [0, 2i+2], the I problems in [0, 1]
+    bool            wfgRange;
+    // r_nonsep of all the distance parameters, sorted by the batch and
+    // composed versions from r_nonsep_sort_size values on
+    bool            rNonsep;
+    // b_param with the mean of the following values, kept as a running sum
+    // by the batch and composed versions
+    bool            bParamFollowing;
+};
+
+const int NProblems = 14;
+const Problem Problems[NProblems] = {
+    {"WFG1", Examples::Problems::WFG1, Examples::BatchProblems::WFG1,
+     Composed::Examples::WFG1::evaluate, true, false, false},
+    {"WFG2", Examples::Problems::WFG2, Examples::BatchProblems::WFG2,
+     Composed::Examples::WFG2::evaluate, true, false, false},
+    {"WFG3", Examples::Problems::WFG3, Examples::BatchProblems::WFG3,
+     Composed::Examples::WFG3::evaluate, true, false, false},
+    {"WFG4", Examples::Problems::WFG4, Examples::BatchProblems::WFG4,
+     Composed::Examples::WFG4::evaluate, true, false, false},
+    {"WFG5", Examples::Problems::WFG5, Examples::BatchProblems::WFG5,
+     Composed::Examples::WFG5::evaluate, true, false, false},
+    {"WFG6", Examples::Problems::WFG6, Examples::BatchProblems::WFG6,
+     Composed::Examples::WFG6::evaluate, true, true, false},
+    {"WFG7", Examples::Problems::WFG7, Examples::BatchProblems::WFG7,
+     Composed::Examples::WFG7::evaluate, true, false, true},
+    {"WFG8", Examples::Problems::WFG8, Examples::BatchProblems::WFG8,
+     Composed::Examples::WFG8::evaluate, true, false, false},
+    {"WFG9", Examples::Problems::WFG9, Examples::BatchProblems::WFG9,
+     Composed::Examples::WFG9::evaluate, true, true, true},
+    {"I1",   Examples::Problems::I1,   Examples::BatchProblems::I1,
+     Composed::Examples::I1::evaluate,   false, false, false},
+    {"I2",   Examples::Problems::I2,   Examples::BatchProblems::I2,
+     Composed::Examples::I2::evaluate,   false, false, true},
+    {"I3",   Examples::Problems::I3,   Examples::BatchProblems::I3,
+     Composed::Examples::I3::evaluate,   false, false, false},
+    {"I4",   Examples::Problems::I4,   Examples::BatchProblems::I4,
+     Composed::Examples::I4::evaluate,   false, true, false},
+    {"I5",   Examples::Problems::I5,   Examples::BatchProblems::I5,
+     Composed::Examples::I5::evaluate,   false, true, false}
+};
+
+// (n, k, M); the last has distance groups of 32 values or more
+const int NSettings = 4;
+const int Settings[NSettings][3] = {
+    {10, 2, 2}, {24, 4, 3}, {12, 4, 5}, {70, 6, 4}
+};
+
+// Individual j of N, row-major. The first rows are all at the lower
+// bound, all at the upper bound and all at the s_linear knee; the others
+// are random.
+vector<double> population(const Problem& p, int n, int N, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    vector<double> X(N*n);
+    for(int j=0; j<N; j++) {
+        for(int i=0; i<n; i++) {
+            double u = (j == 0) ? 0.0 : (j == 1) ? 1.0 : (j == 2) ? 0.35
+                                                                   : uni(gen);
+            X[j*n+i] = p.wfgRange ? u*2.0*(i+1) : u;
+        }
+    }
+    return X;
+}
+
+// a and b are equal, or within tolerance relative to b
+bool agrees(double a, double b, double tolerance)
+{
+    return a == b || std::fabs(a - b) <= tolerance*std::fabs(b);
+}
+
+void testProblem(const Problem& p)
+{
+    const int N = 67;
+    // the sorted r_nonsep differs from the nested sum by rounding, and the
+    // running sums for b_param from r_sum, which b_param amplifies
+    const double sortedTolerance = 1e-12;
+    const double bParamTolerance = 1e-10;
+
+    int nBatchDiff = 0;
+    int nComposedDiff = 0;
+    for(int s=0; s<NSettings; s++) {
+        int n = Settings[s][0];
+        int k = Settings[s][1];
+        int M = Settings[s][2];
+        vector<double> X = population(p, n, N, 100+s);
+        double tolerance = (p.rNonsep &&
+                            n-k >= InlineTransFunctions::r_nonsep_sort_size)
+                ? sortedTolerance : 0.0;
+        if(p.bParamFollowing) {
+            tolerance = bParamTolerance;
+        }
+
+        // the batch engine takes structure-of-arrays blocks
+        vector<double> z(n*N);
+        for(int j=0; j<N; j++) {
+            for(int i=0; i<n; i++) {
+                z[i*N+j] = X[j*n+i];
+            }
+        }
+        vector<double> f(M*N);
+        vector<double> workspace(
+                    Examples::BatchProblems::workspace_size(n, N, M));
+        p.batch(z.data(), n, N, k, M, f.data(), workspace.data());
+
+        for(int j=0; j<N; j++) {
+            vector<double> x(X.begin()+j*n, X.begin()+(j+1)*n);
+            vector<double> ref = p.scalar(x, k, M);
+            vector<double> comp = p.composed(x, k, M);
+            for(int m=0; m<M; m++) {
+                nBatchDiff    += !agrees(f[m*N+j], ref[m], tolerance);
+                nComposedDiff += !agrees(comp[m], ref[m], tolerance);
+            }
+        }
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "batch %s matches the scalar problem",
+             p.name);
+    check(nBatchDiff == 0, name, nBatchDiff);
+    snprintf(name, sizeof(name), "composed %s matches the scalar problem",
+             p.name);
+    check(nComposedDiff == 0, name, nComposedDiff);
+}
+
+// The numerator of r_nonsep as in the original toolkit
+double nestedNumerator(const vector<double>& y, int A)
+{
+    int len = y.size();
+    double numerator = 0.0;
+    for(int j=0; j<len; j++) {
+        numerator += y[j];
+        for(int k=0; k<=A-2; k++) {
+            numerator += std::fabs(y[j] - y[(j+k+1) % len]);
+        }
+    }
+    return numerator;
+}
+
+// Groups of r_nonsep_sort_size values or more are sorted, and agree with
+// the nested sum within len*eps relative; smaller groups, and windows
+// shorter than the group, take the nested sum itself
+void testRNonsepSorted()
+{
+    const int nLengths = 7;
+    const int lengths[nLengths] = {31, 32, 33, 64, 257, 1000, 4000};
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    for(int l=0; l<nLengths; l++) {
+        int len = lengths[l];
+        double worst = 0.0;
+        // random values, values with many ties, and sorted values
+        for(int c=0; c<3; c++) {
+            vector<double> y(len);
+            for(int i=0; i<len; i++) {
+                y[i] = (c == 1) ? std::floor(10.0*uni(gen)) / 10.0
+                                : uni(gen);
+            }
+            if(c == 2) {
+                std::sort(y.begin(), y.end());
+            }
+            vector<double> sorted(len);
+            double fast = InlineTransFunctions::r_nonsep_numerator(
+                        y.data(), len, len, sorted.data());
+            double ref = nestedNumerator(y, len);
+            worst = std::max(worst, std::fabs(fast - ref) / ref);
+        }
+
+        char name[64];
+        if(len < InlineTransFunctions::r_nonsep_sort_size) {
+            snprintf(name, sizeof(name),
+                     "r_nonsep of %d values is the nested sum", len);
+            check(worst == 0.0, name, worst);
+        } else {
+            snprintf(name, sizeof(name),
+                     "sorted r_nonsep of %d values matches the nested sum",
+                     len);
+            check(worst <= len*DBL_EPSILON, name, worst);
+        }
+    }
+
+    // A < len keeps the window sum
+    vector<double> y(64);
+    for(size_t i=0; i<y.size(); i++) {
+        y[i] = uni(gen);
+    }
+    vector<double> sorted(y.size());
+    double windowed = InlineTransFunctions::r_nonsep_numerator(
+                y.data(), y.size(), 32, sorted.data());
+    check(windowed == nestedNumerator(y, 32),
+          "r_nonsep with A < len is the nested sum", windowed);
+
+    // the reference function keeps the nested sum for every length
+    double denominator = 64*32*(1.0 + 2.0*64 - 2.0*32)/64;
+    double reference = TransFunctions::r_nonsep(y, 64);
+    check(reference == Misc::correct_to_01(nestedNumerator(y, 64) /
+                                           denominator),
+          "TransFunctions::r_nonsep is the nested sum", reference);
+}
+
+} // namespace
+
+int main()
+{
+    for(int p=0; p<NProblems; p++) {
+        testProblem(Problems[p]);
+    }
+    testRNonsepSorted();
+
+    printf("%d failed\n", nFailures);
+    return nFailures;
+}
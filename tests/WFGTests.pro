@@ -0,0 +1,25 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += c++11
+# "make check" runs the target
+CONFIG += testcase
+# bit identity needs unfused multiply-adds, as in CODeM.pro
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+TARGET = WFGTests
+# the test programs share this directory
+OBJECTS_DIR = .obj/$$TARGET
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += WFGTests.cpp \
+    ../libs/WFG/BatchProblems.cpp \
+    ../libs/WFG/ExampleProblems.cpp \
+    ../libs/WFG/ExampleShapes.cpp \
+    ../libs/WFG/ExampleTransitions.cpp \
+    ../libs/WFG/FrameworkFunctions.cpp \
+    ../libs/WFG/Misc.cpp \
+    ../libs/WFG/ShapeFunctions.cpp \
+    ../libs/WFG/TransFunctions.cpp
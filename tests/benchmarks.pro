@@ -0,0 +1,16 @@
+TEMPLATE = subdirs
+
+# one program per benchmark, each printing its own table
+SUBDIRS += ProductBenchmark \
+    ConvolutionBenchmark \
+    RandomBenchmark \
+    AllocationBenchmark \
+    RNonsepBenchmark \
+    BParamBenchmark
+
+ProductBenchmark.file     = ProductBenchmark.pro
+ConvolutionBenchmark.file = ConvolutionBenchmark.pro
+RandomBenchmark.file      = RandomBenchmark.pro
+AllocationBenchmark.file  = AllocationBenchmark.pro
+RNonsepBenchmark.file     = RNonsepBenchmark.pro
+BParamBenchmark.file      = BParamBenchmark.pro
@@ -0,0 +1,18 @@
+TEMPLATE = subdirs
+
+# one program per test suite; each returns its number of failed checks
+SUBDIRS += DistributionTests \
+    RandomStreamTests \
+    ProblemTests \
+    WFGTests \
+    DTLZTests \
+    KernelTests \
+    OperatorTests
+
+DistributionTests.file = DistributionTests.pro
+RandomStreamTests.file = RandomStreamTests.pro
+ProblemTests.file      = ProblemTests.pro
+WFGTests.file          = WFGTests.pro
+DTLZTests.file         = DTLZTests.pro
+KernelTests.file       = KernelTests.pro
+OperatorTests.file     = OperatorTests.pro